@@ -1,4 +1,5 @@
 #include "UWB.h"
+#include "serial_control/serial_control.h"
 
 #ifdef ANCHORMODE
 bool isAnchor = true;
@@ -19,6 +20,9 @@ int measurementBufferIndex;
 float distance = 0.0;
 float avgDistance = 0.0;
 
+PositionPipeline pipeline(trilat);
+TrackerPool<3> tagPool;
+
 // Calibration variables
 bool isCalibrating = false;
 int minDelay;
@@ -36,10 +40,7 @@ void calibrate()
 {
     if (abs(calibrationTarget - distance) < tolerance)
     {
-        Serial.print("Calibration successful");
-        Serial.print(" (delay: ");
-        Serial.print(bestDelay);
-        Serial.println(")");
+        LOG_INFO(LOG_MODULE_UWB, "Calibration successful (delay: %d)", bestDelay);
         isCalibrating = false;
 
         // Save the best delay to preferences
@@ -51,7 +52,7 @@ void calibrate()
 
     if (maxDelay - minDelay <= 1)
     {
-        Serial.println("Calibration converged (delay range too small)");
+        LOG_INFO(LOG_MODULE_UWB, "Calibration converged (delay range too small)");
         isCalibrating = false;
         return;
     }
@@ -60,19 +61,19 @@ void calibrate()
 
     if (avgDistance < calibrationTarget)
     {
-        Serial.println("Decreasing delay");
+        LOG_DEBUG(LOG_MODULE_UWB, "Decreasing delay");
         maxDelay = midDelay;
         bestDelay = midDelay;
     }
     else
     {
-        Serial.println("Increasing delay");
+        LOG_DEBUG(LOG_MODULE_UWB, "Increasing delay");
         minDelay = midDelay;
         bestDelay = midDelay;
     }
 
-    Serial.printf("Current delay: %d, Distance: %.2f, Target: %.2f\n", bestDelay, avgDistance, calibrationTarget);
-    Serial.printf("Min delay: %d, Max delay: %d\n", minDelay, maxDelay);
+    LOG_DEBUG(LOG_MODULE_UWB, "Current delay: %d, Distance: %.2f, Target: %.2f", bestDelay, avgDistance, calibrationTarget);
+    LOG_DEBUG(LOG_MODULE_UWB, "Min delay: %d, Max delay: %d", minDelay, maxDelay);
 
     // DW1000.setAntennaDelay(bestDelay);
 }
@@ -80,12 +81,25 @@ void calibrate()
 /**
  * @brief Callback function to be called when a new range is available
  *
- * This function prints the short address of the distant device, the range, and the RX power.
+ * This function queues the range for the positioning pipeline and logs (at DEBUG level) the short
+ * address of the distant device, the range, and the RX power.
  */
 void newRange()
 {
     distance = DW1000Ranging.getDistantDevice()->getRange();
 
+    // Only queue here: a tag positions itself and an anchor tracks each tag it ranges with from UWB_loop()
+    if (!isAnchor)
+    {
+        pipeline.pushRange(DW1000Ranging.getDistantDevice()->getShortAddress(), distance);
+    }
+    else
+    {
+        byte *ownAddress = DW1000Ranging.getCurrentShortAddress();
+        tagPool.pushRange(DW1000Ranging.getDistantDevice()->getShortAddress(), ownAddress[1] * 256 + ownAddress[0],
+                          distance);
+    }
+
     measurementBuffer[measurementBufferIndex] = distance;
     measurementBufferIndex = (measurementBufferIndex + 1) % measurementBufferSize;
     float sum = 0;
@@ -95,15 +109,9 @@ void newRange()
     }
     avgDistance = sum / measurementBufferSize;
 
-    Serial.print("from: ");
-    Serial.print(DW1000Ranging.getDistantDevice()->getShortAddress(), HEX);
-    Serial.print("\t Range: ");
-    Serial.print(avgDistance);
-    Serial.print(" m");
-    Serial.printf(" (%0.2f m)", distance);
-    Serial.print("\t RX power: ");
-    Serial.print(DW1000Ranging.getDistantDevice()->getRXPower());
-    Serial.println(" dBm");
+    LOG_DEBUG(LOG_MODULE_UWB, "from: %X\t Range: %.2f m (%0.2f m)\t RX power: %.2f dBm",
+              DW1000Ranging.getDistantDevice()->getShortAddress(), avgDistance, distance,
+              DW1000Ranging.getDistantDevice()->getRXPower());
 
     if (isCalibrating)
     {
@@ -121,8 +129,7 @@ void newRange()
  */
 void newDevice(DW1000Device *device)
 {
-    Serial.print("New device added -> Short: ");
-    Serial.println(device->getShortAddress(), HEX);
+    LOG_INFO(LOG_MODULE_UWB, "New device added -> Short: %X", device->getShortAddress());
 }
 
 /**
@@ -132,9 +139,7 @@ void newDevice(DW1000Device *device)
  */
 void newBlink(DW1000Device *device)
 {
-    Serial.print("blink; 1 device added ! -> ");
-    Serial.print(" short:");
-    Serial.println(device->getShortAddress(), HEX);
+    LOG_INFO(LOG_MODULE_UWB, "blink; 1 device added ! ->  short:%X", device->getShortAddress());
 }
 
 /**
@@ -144,8 +149,13 @@ void newBlink(DW1000Device *device)
  */
 void inactiveDevice(DW1000Device *device)
 {
-    Serial.print("delete inactive device: ");
-    Serial.println(device->getShortAddress(), HEX);
+    LOG_INFO(LOG_MODULE_UWB, "delete inactive device: %X", device->getShortAddress());
+
+    // Its tracker is kept, but reused first when a new tag needs one
+    if (isAnchor)
+    {
+        tagPool.markInactive(device->getShortAddress());
+    }
 }
 
 /**
@@ -237,7 +247,7 @@ void handleUwbSwitchMode()
  */
 void handleUwbStatus()
 {
-    StaticJsonDocument<256> status;
+    StaticJsonDocument<384> status;
 
     status["isRanging"] = isRanging;
     status["isAnchor"] = isAnchor;
@@ -252,6 +262,17 @@ void handleUwbStatus()
     otherAddr.toUpperCase();
     status["otherDeviceAddress"] = otherAddr;
 
+    if (pipeline.hasFix())
+    {
+        const PositionFix &fix = pipeline.latest();
+        JsonObject position = status.createNestedObject("position");
+        position["x"] = fix.position[0];
+        position["y"] = fix.position[1];
+        position["z"] = fix.position[2];
+        position["age"] = millis() - fix.timestamp;
+        position["sequence"] = fix.sequence;
+    }
+
     String json;
     serializeJson(status, json);
     server.send(200, "application/json", json);
@@ -353,6 +374,8 @@ void UWB_loop()
     if (isRanging)
     {
         DW1000Ranging.loop();
+        pipeline.process();
+        tagPool.process();
     }
 }
 
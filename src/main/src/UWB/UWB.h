@@ -9,6 +9,9 @@
 #include <Preferences.h>
 
 #include "config.h"
+#include "utils/log.h"
+#include "UWB_tracking_logic/positionPipeline.h"
+#include "UWB_tracking_logic/trackerPool.h"
 
 extern WebServer server;
 extern Preferences preferences;
@@ -19,6 +22,9 @@ extern bool isRanging; // true if ranging is active, false otherwise
 
 extern float avgDistance; // average distance calculated from the measurements
 
+extern PositionPipeline pipeline; // Ranges -> anchor lookup -> solver -> Kalman filter -> position
+extern TrackerPool<3> tagPool;    // Tags ranged in anchor mode, one tracker each
+
 void UWB_setup();
 void UWB_loop();
 void UWB_switchMode();
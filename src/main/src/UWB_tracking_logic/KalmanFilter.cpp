@@ -1,46 +1,95 @@
 #include "KalmanFilter.h"
+#include <algorithm>
+
+// Steady-state gains depend only on the time step, Q and R. Trackers never call
+// adjustKalmanNoise, so Q and R keep their reset() values on the device and one
+// table keyed by the time step serves every filter. Entries are filled by
+// setSteadyState(), never on the update path.
+static const float STEADY_STATE_Q = 1.0f; // Process noise scale the gains are computed for, that of reset()
+static int steadyStateBuckets[KF_STEADY_STATE_RATES]; // Time step of each entry in units of KF_STEADY_STATE_DT_BUCKET, 0 if unused
+static SteadyStateGain steadyStateGains[KF_STEADY_STATE_RATES];
 
 /**
  * @brief Kalman filter constructor.
+ */
+template <int Dims, typename Scalar>
+KalmanFilter<Dims, Scalar>::KalmanFilter()
+    : steadyStateEnabled(false)
+{
+    reset();
+}
+
+/**
+ * @brief Return to the initial state and covariance.
  *
- * @param numOfDimensions Number of dimensions (e.g., 2 for 2D, 3 for 3D)
+ * The precomputed steady-state gains are kept, but are not used again until
+ * the covariance has settled.
  */
-KalmanFilter::KalmanFilter(int numOfDimensions)
-    : X(numOfDimensions * 2, 1),                   // State vector: [x, y, z, vx, vy, vz] for 3D
-      F{numOfDimensions * 2, numOfDimensions * 2}, // State transition matrix
-      P(numOfDimensions * 2, numOfDimensions * 2), // Covariance matrix
-      Q(numOfDimensions * 2, numOfDimensions * 2), // Process noise covariance
-      H(numOfDimensions, numOfDimensions * 2),     // Measurement matrix
-      R(numOfDimensions, numOfDimensions),         // Measurement noise covariance
-      I(numOfDimensions * 2, numOfDimensions * 2)  // Identity matrix
+template <int Dims, typename Scalar>
+void KalmanFilter<Dims, Scalar>::reset()
 {
-    this->numOfDimensions = numOfDimensions;
-    
     // Initialize matrices
+    X.set_value(0);
     F.set_identity();
     P.set_identity(10);
     Q.set_identity();
-    H.set_identity();
     R.set_identity(1);
-    I.set_identity();
+    currentQScale = STEADY_STATE_Q;
+
+    activeGain = nullptr;
+    lastDtBucket = -1;
+    lastQ = 0;
+    steadySteps = 0;
 }
 
 /**
  * @brief Predict the next state of the system.
  *
+ * In steady-state mode, once the time step has stayed in the same bucket for
+ * KF_STEADY_STATE_SETTLE steps, the covariance is no longer propagated:
+ * update() applies the converged gain for that time step instead. A step in
+ * another bucket, e.g. a missed ranging round, or a process noise changed by
+ * adjustKalmanNoise restores the steady-state covariance and propagates it in
+ * full again.
+ *
  * @param dt Time step
  */
-void KalmanFilter::predict(float dt)
+template <int Dims, typename Scalar>
+void KalmanFilter<Dims, Scalar>::predict(Scalar dt)
 {
     // Update state transition matrix (F) for dt
-    for (int i = 0; i < numOfDimensions; ++i)
+    for (int i = 0; i < Dims; ++i)
     {
-        F[i][i + numOfDimensions] = dt;
+        F[i][i + Dims] = dt;
     }
 
     // Predict next state
     X = F * X;
 
+    if (steadyStateEnabled)
+    {
+        int dtBucket = (int)((float)dt / KF_STEADY_STATE_DT_BUCKET + 0.5f);
+        if (dtBucket == lastDtBucket && currentQScale == lastQ)
+        {
+            ++steadySteps;
+        }
+        else
+        {
+            leaveSteadyState();
+            lastDtBucket = dtBucket;
+            lastQ = currentQScale;
+            steadySteps = 0;
+        }
+        if (!activeGain && steadySteps >= KF_STEADY_STATE_SETTLE)
+        {
+            activeGain = steadyStateGain(dtBucket);
+        }
+        if (activeGain)
+        {
+            return;
+        }
+    }
+
     // Predict covariance
     P = F * P * F.transpose() + Q;
 }
@@ -50,26 +99,142 @@ void KalmanFilter::predict(float dt)
  *
  * @param measurement Measurement vector
  */
-void KalmanFilter::update(const Matrix &measurement)
+template <int Dims, typename Scalar>
+void KalmanFilter<Dims, Scalar>::update(const MeasurementVector &measurement)
 {
-    Matrix Y = measurement.transpose() - (H * X);           // Measurement residual
-    Matrix S = H * P * H.transpose() + R;       // Residual covariance
-    Matrix K = P * H.transpose() * S.inverseQR(); // Kalman gain
+    if (activeGain)
+    {
+        // Converged gain: K = [kp I; kv I], P stays at its steady state
+        const Scalar kp = activeGain->kp;
+        const Scalar kv = activeGain->kv;
+        for (int i = 0; i < Dims; ++i)
+        {
+            Scalar y = measurement(i, 0) - X[i][0];
+            X[i][0] += kp * y;
+            X[i + Dims][0] += kv * y;
+        }
+        return;
+    }
+
+    // H only selects the position block, so H * X, H * P and P * H^T are
+    // row/column selections rather than multiplications
+    MeasurementVector Y = measurement - H * X;                     // Measurement residual
+    FixedMatrix<Dims, Dims, Scalar> S = H * P * H.transpose() + R; // Residual covariance
+
+    // Kalman gain K = P * H^T * S^-1. S is symmetric positive definite and P is
+    // symmetric, so solve S * K^T = H * P instead of forming the inverse.
+    FixedMatrix<Dims, StateSize, Scalar> Kt = H * P;
+    Cholesky<FixedMatrix<Dims, Dims, Scalar>> cholesky(S);
+    if (cholesky.success())
+    {
+        cholesky.solveInPlace(Kt.view());
+    }
+    else
+    {
+        // S lost positive definiteness to rounding; fall back to a pivoted solve
+        PartialPivLU<FixedMatrix<Dims, Dims, Scalar>> lu(S);
+        if (!lu.success())
+        {
+            return;
+        }
+        lu.solveInPlace(Kt.view());
+    }
+    FixedMatrix<StateSize, Dims, Scalar> K = Kt.transpose();
 
     // Update state
     X = X + K * Y;
 
-    // Update covariance
-    P = (I - K * H) * P;
+    // Update covariance, (I - K * H) * P expanded so H * P stays a row selection
+    P = P - K * (H * P);
+}
+
+/**
+ * @brief Extended Kalman update with a single range to an anchor.
+ *
+ * The range is linearized around the current position: its Jacobian is the
+ * unit vector u from the anchor to the position, zero for the velocity. With
+ * one scalar measurement the residual covariance is 1x1, so the gain is
+ * P * H^T divided by it and no factorization is needed. Ranges can be
+ * applied one at a time, as they arrive, even while fewer anchors than
+ * dimensions are in view.
+ *
+ * @param anchor Anchor coordinates (Dims values)
+ * @param range Measured distance to the anchor
+ * @param variance Variance of the range measurement
+ * @param gate Reject ranges whose squared normalized residual exceeds this (0 = accept all)
+ * @return true if the state was updated
+ */
+template <int Dims, typename Scalar>
+bool KalmanFilter<Dims, Scalar>::updateRange(const Scalar *anchor, Scalar range, Scalar variance, Scalar gate)
+{
+    // A range couples the axes, which the steady-state gains assume are independent
+    leaveSteadyState();
+    steadySteps = 0;
+
+    Scalar u[Dims];
+    Scalar predicted = 0;
+    for (int i = 0; i < Dims; ++i)
+    {
+        u[i] = X[i][0] - anchor[i];
+        predicted += u[i] * u[i];
+    }
+    predicted = sqrt(predicted);
+    if (predicted < Scalar(EKF_MIN_RANGE))
+    {
+        return false;
+    }
+    for (int i = 0; i < Dims; ++i)
+    {
+        u[i] = u[i] / predicted;
+    }
+
+    // P * H^T, with H = [u^T 0] touching only the position columns
+    Scalar PHt[StateSize];
+    for (int r = 0; r < StateSize; ++r)
+    {
+        PHt[r] = 0;
+        for (int i = 0; i < Dims; ++i)
+        {
+            PHt[r] += P[r][i] * u[i];
+        }
+    }
+    Scalar S = variance; // Residual covariance H * P * H^T + R
+    for (int i = 0; i < Dims; ++i)
+    {
+        S += u[i] * PHt[i];
+    }
+    if (S <= Scalar(0))
+    {
+        return false;
+    }
+
+    Scalar y = range - predicted; // Measurement residual
+    if (gate > Scalar(0) && y * y > gate * S)
+    {
+        return false;
+    }
+
+    // K = P * H^T / S; X += K * y; P -= K * (H * P), where H * P = (P * H^T)^T
+    for (int r = 0; r < StateSize; ++r)
+    {
+        Scalar K = PHt[r] / S;
+        X[r][0] += K * y;
+        for (int c = 0; c < StateSize; ++c)
+        {
+            P[r][c] -= K * PHt[c];
+        }
+    }
+    return true;
 }
 
 /**
  * @brief Get the current state of the system.
  *
- * @return Matrix State vector [x, y, z, vx, vy, vz] for 3D
+ * @return StateVector State vector [x, y, z, vx, vy, vz] for 3D
  * @note The state vector contains the position and velocity in each dimension.
  */
-Matrix KalmanFilter::getState() const
+template <int Dims, typename Scalar>
+typename KalmanFilter<Dims, Scalar>::StateVector KalmanFilter<Dims, Scalar>::getState() const
 {
     return X; // Return position (x, y, z, vx, vy, vz)
 }
@@ -77,20 +242,629 @@ Matrix KalmanFilter::getState() const
 /**
  * @brief Adjust the process noise covariance matrix based on the current speed.
  */
-void KalmanFilter::adjustKalmanNoise()
+template <int Dims, typename Scalar>
+void KalmanFilter<Dims, Scalar>::adjustKalmanNoise()
 {
-    static const float Q_MIN = 0.5f;  // Minimum process noise (stationary)
-    static const float Q_MAX = 20.0f; // Maximum process noise (fast movement)
-    static const float SCALE_FACTOR = 10.0f;
+    static const Scalar Q_MIN = 0.5f;  // Minimum process noise (stationary)
+    static const Scalar Q_MAX = 20.0f; // Maximum process noise (fast movement)
+    static const Scalar SCALE_FACTOR = 10.0f;
 
-    float speed = 0.0f;
-    for (int i = 0; i < numOfDimensions; ++i)
+    Scalar speed = 0;
+    for (int i = 0; i < Dims; ++i)
     {
-        speed += pow(X[i + numOfDimensions][0], 2); // Sum of squared velocities
+        speed += X[i + Dims][0] * X[i + Dims][0]; // Sum of squared velocities
     }
     speed = sqrt(speed);
 
     currentQScale = Q_MIN + (Q_MAX - Q_MIN) * (speed / SCALE_FACTOR);
-
     Q.set_identity(currentQScale);
 }
+
+/**
+ * @brief Converged steady-state gain for a time step and process noise.
+ *
+ * With Q = qI and R = rI every axis follows the same 2x2 discrete Riccati
+ * recursion, iterated here until the gain stops changing.
+ */
+static void solveSteadyState(float dt, float q, float r, SteadyStateGain &gain)
+{
+    float pp = 10, pv = 0, vv = 10, kp = 0, kv = 0;
+    for (int iteration = 0; iteration < 1000; ++iteration)
+    {
+        float dtvv = dt * vv;
+        pp += dt * (pv + pv + dtvv) + q;
+        pv += dtvv;
+        vv += q;
+        float S = pp + r;
+        float newKp = pp / S;
+        float newKv = pv / S;
+        vv -= newKv * pv;
+        pv -= newKp * pv;
+        pp -= newKp * pp;
+        bool converged = fabsf(newKp - kp) < 1e-7f && fabsf(newKv - kv) < 1e-7f;
+        kp = newKp;
+        kv = newKv;
+        if (converged)
+        {
+            break;
+        }
+    }
+    gain = {kp, kv, pp, pv, vv};
+}
+
+/**
+ * @brief Enable or disable steady-state gains; disabling restores full propagation.
+ *
+ * Enabling precomputes the gains for the expected time step, unless an
+ * earlier call already did, so predict() only looks them up. At other time
+ * steps, or with the process noise adapted by adjustKalmanNoise, the
+ * covariance is propagated in full.
+ *
+ * @param enabled Use steady-state gains
+ * @param dt Expected time step (s)
+ */
+template <int Dims, typename Scalar>
+void KalmanFilter<Dims, Scalar>::setSteadyState(bool enabled, float dt)
+{
+    leaveSteadyState();
+    steadyStateEnabled = enabled;
+    steadySteps = 0;
+
+    int dtBucket = (int)(dt / KF_STEADY_STATE_DT_BUCKET + 0.5f);
+    if (!enabled || dtBucket <= 0)
+    {
+        return;
+    }
+    int row = 0;
+    while (row < KF_STEADY_STATE_RATES && steadyStateBuckets[row] != 0 && steadyStateBuckets[row] != dtBucket)
+    {
+        ++row;
+    }
+    if (row == KF_STEADY_STATE_RATES)
+    {
+        LOG_WARN(LOG_MODULE_TRILATERATION, "Warning: No room for steady-state gains at dt %.3f s (KF_STEADY_STATE_RATES %d).",
+                 dt, KF_STEADY_STATE_RATES);
+        return;
+    }
+    if (steadyStateBuckets[row] == dtBucket)
+    {
+        return;
+    }
+    solveSteadyState(dtBucket * KF_STEADY_STATE_DT_BUCKET, STEADY_STATE_Q, (float)R(0, 0), steadyStateGains[row]);
+    steadyStateBuckets[row] = dtBucket;
+    LOG_DEBUG(LOG_MODULE_TRILATERATION, "Steady-state gains for dt %.3f s", dtBucket * KF_STEADY_STATE_DT_BUCKET);
+}
+
+/**
+ * @brief Precomputed steady-state gain for a time step at the current process noise
+ *
+ * @param dtBucket Time step in units of KF_STEADY_STATE_DT_BUCKET
+ * @return const SteadyStateGain* The gain, or nullptr if none was precomputed
+ */
+template <int Dims, typename Scalar>
+const SteadyStateGain *KalmanFilter<Dims, Scalar>::steadyStateGain(int dtBucket) const
+{
+    if (currentQScale != Scalar(STEADY_STATE_Q))
+    {
+        return nullptr;
+    }
+    for (int row = 0; row < KF_STEADY_STATE_RATES && steadyStateBuckets[row] != 0; ++row)
+    {
+        if (steadyStateBuckets[row] == dtBucket)
+        {
+            return &steadyStateGains[row];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Resume full propagation from the steady-state covariance
+ */
+template <int Dims, typename Scalar>
+void KalmanFilter<Dims, Scalar>::leaveSteadyState()
+{
+    if (!activeGain)
+    {
+        return;
+    }
+    steadyCovariance(*activeGain, P);
+    activeGain = nullptr;
+}
+
+/**
+ * @brief Covariance the filter has while a steady-state gain is applied
+ */
+template <int Dims, typename Scalar>
+void KalmanFilter<Dims, Scalar>::steadyCovariance(const SteadyStateGain &gain, StateMatrix &covariance) const
+{
+    covariance.set_value(0);
+    for (int i = 0; i < Dims; ++i)
+    {
+        covariance[i][i] = gain.pp;
+        covariance[i][i + Dims] = gain.pv;
+        covariance[i + Dims][i] = gain.pv;
+        covariance[i + Dims][i + Dims] = gain.vv;
+    }
+}
+
+/**
+ * @brief Copy the state and covariance
+ */
+template <int Dims, typename Scalar>
+void KalmanFilter<Dims, Scalar>::save(Snapshot &snapshot) const
+{
+    snapshot.X = X;
+    if (activeGain)
+    {
+        steadyCovariance(*activeGain, snapshot.P);
+    }
+    else
+    {
+        snapshot.P = P;
+    }
+}
+
+/**
+ * @brief Return to a saved state and covariance; propagation restarts in full
+ */
+template <int Dims, typename Scalar>
+void KalmanFilter<Dims, Scalar>::restore(const Snapshot &snapshot)
+{
+    X = snapshot.X;
+    P = snapshot.P;
+    activeGain = nullptr;
+    steadySteps = 0;
+}
+
+/**
+ * @brief Decoupled filter constructor; starts from the same state as KalmanFilter.
+ */
+template <int Dims, typename Scalar>
+DecoupledKalmanFilter<Dims, Scalar>::DecoupledKalmanFilter()
+{
+    reset();
+}
+
+/**
+ * @brief Return to the initial state and covariance.
+ */
+template <int Dims, typename Scalar>
+void DecoupledKalmanFilter<Dims, Scalar>::reset()
+{
+    for (int i = 0; i < Dims; ++i)
+    {
+        axes[i].position = 0;
+        axes[i].velocity = 0;
+        axes[i].pp = 10;
+        axes[i].pv = 0;
+        axes[i].vv = 10;
+    }
+    q = 1;
+    r = 1;
+}
+
+/**
+ * @brief Copy the state and covariance
+ */
+template <int Dims, typename Scalar>
+void DecoupledKalmanFilter<Dims, Scalar>::save(Snapshot &snapshot) const
+{
+    std::copy(axes, axes + Dims, snapshot.axes);
+}
+
+/**
+ * @brief Return to a saved state and covariance
+ */
+template <int Dims, typename Scalar>
+void DecoupledKalmanFilter<Dims, Scalar>::restore(const Snapshot &snapshot)
+{
+    std::copy(snapshot.axes, snapshot.axes + Dims, axes);
+}
+
+/**
+ * @brief Predict the next state of every axis.
+ *
+ * F = [1 dt; 0 1] per axis, so F * P * F^T + Q expands to three scalar updates.
+ *
+ * @param dt Time step
+ */
+template <int Dims, typename Scalar>
+void DecoupledKalmanFilter<Dims, Scalar>::predict(Scalar dt)
+{
+    for (int i = 0; i < Dims; ++i)
+    {
+        Axis &a = axes[i];
+        a.position += a.velocity * dt;
+        Scalar dtvv = dt * a.vv;
+        a.pp += dt * (a.pv + a.pv + dtvv) + q;
+        a.pv += dtvv;
+        a.vv += q;
+    }
+}
+
+/**
+ * @brief Update every axis with its coordinate of a position fix.
+ *
+ * H = [1 0] per axis, so the residual covariance is the scalar pp + r.
+ *
+ * @param measurement Measurement vector
+ */
+template <int Dims, typename Scalar>
+void DecoupledKalmanFilter<Dims, Scalar>::update(const MeasurementVector &measurement)
+{
+    for (int i = 0; i < Dims; ++i)
+    {
+        Axis &a = axes[i];
+        Scalar S = a.pp + r;
+        if (S <= Scalar(0))
+        {
+            continue;
+        }
+        Scalar kp = a.pp / S;
+        Scalar kv = a.pv / S;
+        Scalar y = measurement(i, 0) - a.position;
+        a.position += kp * y;
+        a.velocity += kv * y;
+
+        // P - K * H * P, with H * P = [pp pv]
+        a.vv -= kv * a.pv;
+        a.pv -= kp * a.pv;
+        a.pp -= kp * a.pp;
+    }
+}
+
+/**
+ * @brief Ranges are not applied: one couples the axes, which this filter keeps independent.
+ *
+ * Trackers keep tightly coupled mode off with this filter, so no range
+ * reaches it; the signature matches KalmanFilter::updateRange().
+ *
+ * @return false, the state is unchanged
+ */
+template <int Dims, typename Scalar>
+bool DecoupledKalmanFilter<Dims, Scalar>::updateRange(const Scalar * /* anchor */, Scalar /* range */, Scalar /* variance */,
+                                                      Scalar /* gate */)
+{
+    return false;
+}
+
+/**
+ * @brief Get the current state, laid out as KalmanFilter's.
+ *
+ * @return StateVector State vector [x, y, z, vx, vy, vz] for 3D
+ */
+template <int Dims, typename Scalar>
+typename DecoupledKalmanFilter<Dims, Scalar>::StateVector DecoupledKalmanFilter<Dims, Scalar>::getState() const
+{
+    StateVector X;
+    for (int i = 0; i < Dims; ++i)
+    {
+        X(i, 0) = axes[i].position;
+        X(i + Dims, 0) = axes[i].velocity;
+    }
+    return X;
+}
+
+/**
+ * @brief Adjust the process noise based on the current speed, as KalmanFilter does.
+ */
+template <int Dims, typename Scalar>
+void DecoupledKalmanFilter<Dims, Scalar>::adjustKalmanNoise()
+{
+    static const Scalar Q_MIN = 0.5f;  // Minimum process noise (stationary)
+    static const Scalar Q_MAX = 20.0f; // Maximum process noise (fast movement)
+    static const Scalar SCALE_FACTOR = 10.0f;
+
+    Scalar speed = 0;
+    for (int i = 0; i < Dims; ++i)
+    {
+        speed += axes[i].velocity * axes[i].velocity;
+    }
+    speed = sqrt(speed);
+
+    q = Q_MIN + (Q_MAX - Q_MIN) * (speed / SCALE_FACTOR);
+}
+
+/**
+ * @brief UD filter constructor; starts from the same state as KalmanFilter.
+ */
+template <int Dims, typename Scalar>
+UDKalmanFilter<Dims, Scalar>::UDKalmanFilter()
+{
+    reset();
+}
+
+/**
+ * @brief Return to the initial state and covariance.
+ */
+template <int Dims, typename Scalar>
+void UDKalmanFilter<Dims, Scalar>::reset()
+{
+    X.set_value(0);
+    U.set_identity();
+    for (int i = 0; i < StateSize; ++i)
+    {
+        D[i] = 10;
+    }
+    q = 1;
+    r = 1;
+}
+
+/**
+ * @brief Copy the state and covariance factors
+ */
+template <int Dims, typename Scalar>
+void UDKalmanFilter<Dims, Scalar>::save(Snapshot &snapshot) const
+{
+    snapshot.X = X;
+    snapshot.U = U;
+    std::copy(D, D + StateSize, snapshot.D);
+}
+
+/**
+ * @brief Return to saved state and covariance factors
+ */
+template <int Dims, typename Scalar>
+void UDKalmanFilter<Dims, Scalar>::restore(const Snapshot &snapshot)
+{
+    X = snapshot.X;
+    U = snapshot.U;
+    std::copy(snapshot.D, snapshot.D + StateSize, D);
+}
+
+/**
+ * @brief Predict the next state and the factors of F * P * F^T + Q (Thornton).
+ *
+ * The rows of W = [F * U | I] with weights diag(D, Q) are orthogonalized
+ * from the last to the first; the weighted norms become the new D and the
+ * projection coefficients the new U.
+ *
+ * @param dt Time step
+ */
+template <int Dims, typename Scalar>
+void UDKalmanFilter<Dims, Scalar>::predict(Scalar dt)
+{
+    for (int i = 0; i < Dims; ++i)
+    {
+        X[i][0] += dt * X[i + Dims][0];
+    }
+
+    // W = [F * U | I]; F adds dt times the velocity row to each position row
+    Scalar W[StateSize][2 * StateSize];
+    Scalar weights[2 * StateSize];
+    for (int i = 0; i < StateSize; ++i)
+    {
+        for (int k = 0; k < StateSize; ++k)
+        {
+            W[i][k] = U[i][k] + (i < Dims ? dt * U[i + Dims][k] : Scalar(0));
+            W[i][k + StateSize] = i == k ? Scalar(1) : Scalar(0);
+        }
+        weights[i] = D[i];
+        weights[i + StateSize] = q;
+    }
+
+    for (int j = StateSize - 1; j >= 0; --j)
+    {
+        Scalar sigma = 0;
+        for (int k = 0; k < 2 * StateSize; ++k)
+        {
+            sigma += W[j][k] * W[j][k] * weights[k];
+        }
+        D[j] = sigma;
+        for (int i = 0; i < j; ++i)
+        {
+            Scalar projection = 0;
+            for (int k = 0; k < 2 * StateSize; ++k)
+            {
+                projection += W[i][k] * weights[k] * W[j][k];
+            }
+            projection /= sigma;
+            U[i][j] = projection;
+            for (int k = 0; k < 2 * StateSize; ++k)
+            {
+                W[i][k] -= projection * W[j][k];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Update with a position fix, one coordinate at a time.
+ *
+ * R is diagonal, so the coordinates are independent scalar measurements with
+ * h = e_i, for which U^T * h is row i of U.
+ *
+ * @param measurement Measurement vector
+ */
+template <int Dims, typename Scalar>
+void UDKalmanFilter<Dims, Scalar>::update(const MeasurementVector &measurement)
+{
+    for (int m = 0; m < Dims; ++m)
+    {
+        Scalar f[StateSize];
+        for (int j = 0; j < StateSize; ++j)
+        {
+            f[j] = U[m][j];
+        }
+        measure(f, r, measurement(m, 0) - X[m][0]);
+    }
+}
+
+/**
+ * @brief Extended Kalman update with a single range to an anchor.
+ *
+ * As KalmanFilter::updateRange(), with h = [u^T 0] for the unit vector u from
+ * the anchor to the position, applied to the factors by the same scalar
+ * update as a coordinate of a fix.
+ *
+ * @param anchor Anchor coordinates (Dims values)
+ * @param range Measured distance to the anchor
+ * @param variance Variance of the range measurement
+ * @param gate Reject ranges whose squared normalized residual exceeds this (0 = accept all)
+ * @return true if the state was updated
+ */
+template <int Dims, typename Scalar>
+bool UDKalmanFilter<Dims, Scalar>::updateRange(const Scalar *anchor, Scalar range, Scalar variance, Scalar gate)
+{
+    Scalar u[Dims];
+    Scalar predicted = 0;
+    for (int i = 0; i < Dims; ++i)
+    {
+        u[i] = X[i][0] - anchor[i];
+        predicted += u[i] * u[i];
+    }
+    predicted = sqrt(predicted);
+    if (predicted < Scalar(EKF_MIN_RANGE))
+    {
+        return false;
+    }
+
+    // f = U^T * h; U is upper triangular, so only rows up to j contribute to f[j]
+    Scalar f[StateSize];
+    Scalar S = variance; // Residual covariance h^T * U * D * U^T * h + R
+    for (int j = 0; j < StateSize; ++j)
+    {
+        f[j] = 0;
+        for (int i = 0; i < Dims && i <= j; ++i)
+        {
+            f[j] += u[i] / predicted * U[i][j];
+        }
+        S += D[j] * f[j] * f[j];
+    }
+
+    Scalar y = range - predicted; // Measurement residual
+    if (gate > Scalar(0) && y * y > gate * S)
+    {
+        return false;
+    }
+    measure(f, variance, y);
+    return true;
+}
+
+/**
+ * @brief Apply one scalar measurement to the state and the factors (Bierman).
+ *
+ * Rescales D and updates U and the gain in a single pass, without a
+ * covariance subtraction that could lose definiteness.
+ *
+ * @param f U^T * h for the measurement row h
+ * @param variance Variance of the measurement
+ * @param residual Measurement minus h * X
+ */
+template <int Dims, typename Scalar>
+void UDKalmanFilter<Dims, Scalar>::measure(const Scalar *f, Scalar variance, Scalar residual)
+{
+    Scalar v[StateSize], gain[StateSize];
+    for (int j = 0; j < StateSize; ++j)
+    {
+        v[j] = D[j] * f[j];
+    }
+
+    Scalar alpha = variance;
+    for (int j = 0; j < StateSize; ++j)
+    {
+        Scalar previous = alpha;
+        alpha += f[j] * v[j];
+        Scalar lambda = -f[j] / previous;
+        D[j] = D[j] * previous / alpha;
+        for (int i = 0; i < j; ++i)
+        {
+            Scalar u = U[i][j];
+            U[i][j] = u + gain[i] * lambda;
+            gain[i] += u * v[j];
+        }
+        gain[j] = v[j];
+    }
+
+    for (int i = 0; i < StateSize; ++i)
+    {
+        X[i][0] += gain[i] / alpha * residual;
+    }
+}
+
+/**
+ * @brief Get the current state, laid out as KalmanFilter's.
+ *
+ * @return StateVector State vector [x, y, z, vx, vy, vz] for 3D
+ */
+template <int Dims, typename Scalar>
+typename UDKalmanFilter<Dims, Scalar>::StateVector UDKalmanFilter<Dims, Scalar>::getState() const
+{
+    return X;
+}
+
+/**
+ * @brief Adjust the process noise based on the current speed, as KalmanFilter does.
+ */
+template <int Dims, typename Scalar>
+void UDKalmanFilter<Dims, Scalar>::adjustKalmanNoise()
+{
+    static const Scalar Q_MIN = 0.5f;  // Minimum process noise (stationary)
+    static const Scalar Q_MAX = 20.0f; // Maximum process noise (fast movement)
+    static const Scalar SCALE_FACTOR = 10.0f;
+
+    Scalar speed = 0;
+    for (int i = 0; i < Dims; ++i)
+    {
+        speed += X[i + Dims][0] * X[i + Dims][0];
+    }
+    speed = sqrt(speed);
+
+    q = Q_MIN + (Q_MAX - Q_MIN) * (speed / SCALE_FACTOR);
+}
+
+/**
+ * @brief Rebuild P = U * D * U^T, for inspection
+ */
+template <int Dims, typename Scalar>
+void UDKalmanFilter<Dims, Scalar>::covariance(StateMatrix &P) const
+{
+    for (int i = 0; i < StateSize; ++i)
+    {
+        for (int j = 0; j < StateSize; ++j)
+        {
+            Scalar sum = 0;
+            for (int k = std::max(i, j); k < StateSize; ++k)
+            {
+                sum += U[i][k] * D[k] * U[j][k];
+            }
+            P[i][j] = sum;
+        }
+    }
+}
+
+/**
+ * @brief Smallest entry of D; P is positive definite while it is positive
+ */
+template <int Dims, typename Scalar>
+Scalar UDKalmanFilter<Dims, Scalar>::minDiagonal() const
+{
+    Scalar smallest = D[0];
+    for (int i = 1; i < StateSize; ++i)
+    {
+        smallest = std::min(smallest, D[i]);
+    }
+    return smallest;
+}
+
+template class KalmanFilter<2>;
+template class KalmanFilter<3>;
+template class KalmanFilter<2, double>;
+template class KalmanFilter<3, double>;
+template class KalmanFilter<2, Q16_16>;
+template class KalmanFilter<3, Q16_16>;
+template class KalmanFilter<2, Q8_24>;
+template class KalmanFilter<3, Q8_24>;
+template class DecoupledKalmanFilter<2>;
+template class DecoupledKalmanFilter<3>;
+template class DecoupledKalmanFilter<2, double>;
+template class DecoupledKalmanFilter<3, double>;
+template class DecoupledKalmanFilter<2, Q16_16>;
+template class DecoupledKalmanFilter<3, Q16_16>;
+template class DecoupledKalmanFilter<2, Q8_24>;
+template class DecoupledKalmanFilter<3, Q8_24>;
+template class UDKalmanFilter<2>;
+template class UDKalmanFilter<3>;
+template class UDKalmanFilter<2, double>;
+template class UDKalmanFilter<3, double>;
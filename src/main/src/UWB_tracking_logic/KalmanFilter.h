@@ -1,30 +1,217 @@
 #ifndef KALMAN_FILTER_H
 #define KALMAN_FILTER_H
 
-#include "matrix.h"
+#include "fixedMatrix.h"
+#include "factorization.h"
+
+#ifndef EKF_MIN_RANGE
+#define EKF_MIN_RANGE 0.01f // Closer than this to an anchor, the range gives no direction
+#endif
+
+#ifndef KF_STEADY_STATE_DT_BUCKET
+#define KF_STEADY_STATE_DT_BUCKET 0.005f // Time steps within the same bucket (s) share steady-state gains
+#endif
+
+#ifndef KF_STEADY_STATE_SETTLE
+#define KF_STEADY_STATE_SETTLE 20 // Steps at the same dt bucket and process noise before the gains are used
+#endif
+
+#ifndef KF_STEADY_STATE_DT
+#define KF_STEADY_STATE_DT 0.1f // Expected time step (s) whose gains are precomputed when steady-state mode is enabled
+#endif
+
+#ifndef KF_STEADY_STATE_RATES
+#define KF_STEADY_STATE_RATES 2 // Time steps with precomputed steady-state gains, shared by all filters
+#endif
 
 /**
- * @brief Kalman filter class.
+ * @brief Converged per-axis gain and posterior covariance for one time step
  */
+struct SteadyStateGain
+{
+    float kp, kv;     // Gain [kp; kv] of each axis
+    float pp, pv, vv; // Posterior covariance block [pp pv; pv vv] of each axis
+};
+
+/**
+ * @brief Constant-velocity Kalman filter class.
+ *
+ * @tparam Dims Number of spatial dimensions (2 for 2D, 3 for 3D)
+ * @tparam Scalar Arithmetic type: float on the device, double for host
+ *         reference runs, Q16_16 or Q8_24 for builds without FPU use
+ */
+template <int Dims, typename Scalar = float>
 class KalmanFilter
 {
 public:
-    KalmanFilter(int numvberOfDimensions = 3);
-    void predict(float dt);
-    void update(const Matrix &measurement);
-    Matrix getState() const;
+    static const int StateSize = Dims * 2;
+
+    typedef FixedMatrix<StateSize, 1, Scalar> StateVector;
+    typedef FixedMatrix<StateSize, StateSize, Scalar> StateMatrix;
+    typedef FixedMatrix<Dims, 1, Scalar> MeasurementVector;
+
+    /**
+     * @brief State and covariance at one instant, to return to later
+     */
+    struct Snapshot
+    {
+        StateVector X;
+        StateMatrix P;
+    };
+
+    KalmanFilter();
+    void reset();
+    void save(Snapshot &snapshot) const;
+    void restore(const Snapshot &snapshot);
+    void predict(Scalar dt);
+    void update(const MeasurementVector &measurement);
+    bool updateRange(const Scalar *anchor, Scalar range, Scalar variance, Scalar gate = 0);
+    StateVector getState() const;
+    void adjustKalmanNoise();
+
+    void setSteadyState(bool enabled, float dt = KF_STEADY_STATE_DT);
+    bool isSteady() const { return activeGain != nullptr; }
+
+private:
+    const SteadyStateGain *steadyStateGain(int dtBucket) const;
+    void steadyCovariance(const SteadyStateGain &gain, StateMatrix &covariance) const;
+    void leaveSteadyState();
+
+    StateVector X;                          // State vector [x, y, z, vx, vy, vz]
+    StateMatrix F;                          // State transition matrix
+    StateMatrix P;                          // Covariance matrix
+    StateMatrix Q;                          // Process noise covariance
+    SelectionMatrix<Dims, StateSize, 0, Scalar> H; // Measurement matrix [I 0]
+    FixedMatrix<Dims, Dims, Scalar> R;      // Measurement noise covariance
+    Scalar currentQScale;                   // Current process noise scale
+
+    bool steadyStateEnabled;
+    const SteadyStateGain *activeGain; // Gain applied while P is not propagated, nullptr otherwise
+    int lastDtBucket;                  // Operating point of the previous predict
+    Scalar lastQ;
+    int steadySteps;                   // Consecutive predicts at that operating point
+};
+
+/**
+ * @brief Constant-velocity Kalman filter run as independent axes.
+ *
+ * With diagonal Q and R and position-only measurements, the dense filter's
+ * covariance never couples the axes: it stays block diagonal with one 2x2
+ * position/velocity block per axis. This variant stores only those blocks
+ * and runs the closed-form 2x2 predict and update per axis, O(Dims) instead
+ * of dense 2Dims x 2Dims products, with the same results as KalmanFilter for
+ * the same noise. Use KalmanFilter for correlated noise or range updates.
+ *
+ * Offers the interface Trilateration needs, so trackers can run on it (see
+ * TRACKER_FILTER_DECOUPLED) as long as tightly coupled mode is off.
+ *
+ * @tparam Dims Number of spatial dimensions (2 for 2D, 3 for 3D)
+ * @tparam Scalar Arithmetic type, as for KalmanFilter
+ */
+template <int Dims, typename Scalar = float>
+class DecoupledKalmanFilter
+{
+public:
+    static const int StateSize = Dims * 2;
+
+    typedef FixedMatrix<StateSize, 1, Scalar> StateVector;
+    typedef FixedMatrix<Dims, 1, Scalar> MeasurementVector;
+
+    /**
+     * @brief State and covariance block of one axis
+     */
+    struct Axis
+    {
+        Scalar position, velocity;
+        Scalar pp, pv, vv; // Covariance block [pp pv; pv vv]
+    };
+
+    /**
+     * @brief State and covariance at one instant, to return to later
+     */
+    struct Snapshot
+    {
+        Axis axes[Dims];
+    };
+
+    DecoupledKalmanFilter();
+    void reset();
+    void save(Snapshot &snapshot) const;
+    void restore(const Snapshot &snapshot);
+    void predict(Scalar dt);
+    void update(const MeasurementVector &measurement);
+    bool updateRange(const Scalar *anchor, Scalar range, Scalar variance, Scalar gate = 0);
+    StateVector getState() const;
+    void adjustKalmanNoise();
+
+    // Each axis is already a closed-form 2x2 update, so there are no steady-state gains to switch to
+    void setSteadyState(bool /* enabled */, float /* dt */ = KF_STEADY_STATE_DT) {}
+    bool isSteady() const { return false; }
+
+private:
+    Axis axes[Dims];
+    Scalar q; // Process noise, the same on every diagonal entry
+    Scalar r; // Measurement noise per axis
+};
+
+/**
+ * @brief Constant-velocity Kalman filter propagating the UD factors of P.
+ *
+ * P = U * D * U^T with U unit upper triangular and D diagonal. Measurements
+ * are applied one coordinate at a time with Bierman's update and the time
+ * update uses Thornton's modified weighted Gram-Schmidt, so P is never
+ * formed: it stays symmetric by construction and positive definite as long
+ * as D stays positive, which rounding cannot undo. Same model, interface and
+ * starting point as KalmanFilter, for long runs in float; trackers run on it
+ * when TRACKER_FILTER_UD is defined.
+ *
+ * @tparam Dims Number of spatial dimensions (2 for 2D, 3 for 3D)
+ * @tparam Scalar float or double
+ */
+template <int Dims, typename Scalar = float>
+class UDKalmanFilter
+{
+public:
+    static const int StateSize = Dims * 2;
+
+    typedef FixedMatrix<StateSize, 1, Scalar> StateVector;
+    typedef FixedMatrix<StateSize, StateSize, Scalar> StateMatrix;
+    typedef FixedMatrix<Dims, 1, Scalar> MeasurementVector;
+
+    /**
+     * @brief State and covariance factors at one instant, to return to later
+     */
+    struct Snapshot
+    {
+        StateVector X;
+        StateMatrix U;
+        Scalar D[StateSize];
+    };
+
+    UDKalmanFilter();
+    void reset();
+    void save(Snapshot &snapshot) const;
+    void restore(const Snapshot &snapshot);
+    void predict(Scalar dt);
+    void update(const MeasurementVector &measurement);
+    bool updateRange(const Scalar *anchor, Scalar range, Scalar variance, Scalar gate = 0);
+    StateVector getState() const;
     void adjustKalmanNoise();
+    void covariance(StateMatrix &P) const;
+    Scalar minDiagonal() const;
+
+    // Steady-state gains would bypass the factors this filter exists to keep
+    void setSteadyState(bool /* enabled */, float /* dt */ = KF_STEADY_STATE_DT) {}
+    bool isSteady() const { return false; }
 
 private:
-    int numOfDimensions; // Number of dimensions (2D or 3D)
-    Matrix X;            // State vector [x, y, z, vx, vy, vz]
-    Matrix F;            // State transition matrix
-    Matrix P;            // Covariance matrix
-    Matrix Q;            // Process noise covariance
-    Matrix H;            // Measurement matrix
-    Matrix R;            // Measurement noise covariance
-    Matrix I;            // Identity matrix
-    float currentQScale; // Current process noise scale
+    void measure(const Scalar *f, Scalar variance, Scalar residual);
+
+    StateVector X;       // State vector [x, y, z, vx, vy, vz]
+    StateMatrix U;       // Unit upper triangular factor
+    Scalar D[StateSize]; // Diagonal factor
+    Scalar q;            // Process noise, the same on every diagonal entry
+    Scalar r;            // Measurement noise per axis
 };
 
 #endif // KALMANFILTER_H
@@ -0,0 +1,219 @@
+#include "anchorGeometry.h"
+#include <string.h>
+
+/**
+ * @brief Create an empty cache; the first solve builds it.
+ */
+template <int Dims>
+AnchorGeometry<Dims>::AnchorGeometry()
+    : key(0), count(0), valid(false), state(TRACKING_NOT_ENOUGH_POINTS), solveDims(Dims)
+{
+}
+
+/**
+ * @brief FNV-1a hash of the anchor coordinates, in order
+ */
+template <int Dims>
+uint32_t AnchorGeometry<Dims>::hashAnchors(const DataPoint *points, int count)
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < count; ++i)
+    {
+        const float coordinates[3] = {points[i].x, points[i].y, points[i].z};
+        uint8_t bytes[sizeof(float) * Dims];
+        memcpy(bytes, coordinates, sizeof(bytes));
+        for (size_t j = 0; j < sizeof(bytes); ++j)
+        {
+            hash = (hash ^ bytes[j]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+/**
+ * @brief Compute and store everything the solve needs that does not depend on the ranges.
+ *
+ * @param points Anchors with fresh ranges, in registry order
+ * @param count Number of anchors
+ */
+template <int Dims>
+void AnchorGeometry<Dims>::build(const DataPoint *points, int count)
+{
+    // Every temporary matrix below lives in the arena, released on return
+    ArenaScope arenaScope(trackingArena);
+    takeTrackingError(); // Drop errors left over from outside the pipeline
+
+    this->key = hashAnchors(points, count);
+    this->count = count;
+    valid = true;
+    state = TRACKING_OK;
+    solveDims = Dims;
+
+    Matrix cords(count, Dims);
+    for (int i = 0; i < count; ++i)
+    {
+        for (int j = 0; j < Dims; ++j)
+        {
+            cords[i][j] = (j == 0) ? points[i].x : (j == 1) ? points[i].y
+                                                            : points[i].z;
+        }
+    }
+
+    // Check if the points are collinear (2D) or coplanar (3D)
+    if (isCollinear(cords))
+    {
+        LOG_WARN(LOG_MODULE_TRILATERATION, "Warning: The points are collinear. Ignoring updates until the anchors change.");
+        state = TRACKING_COLLINEAR;
+        return;
+    }
+
+    // Compute the centroid of the anchor points and center the coordinates
+    Matrix centroidMatrix = computeCentroid(cords);
+    Matrix centeredCords = cords;
+    for (int i = 0; i < count; ++i)
+    {
+        for (int j = 0; j < Dims; ++j)
+        {
+            centeredCords[i][j] -= centroidMatrix[0][j];
+        }
+    }
+    for (int j = 0; j < Dims; ++j)
+    {
+        centroid[j] = centroidMatrix[0][j];
+        for (int s = 0; s < Dims; ++s)
+        {
+            basis[j][s] = (j == s) ? 1 : 0;
+        }
+    }
+    LOG_MATRIX(LOG_MODULE_TRILATERATION, LOG_LEVEL_TRACE, "Centroid:", centroidMatrix);
+
+    // Compute the SVD of the centered coordinates (only Sigma and V are needed)
+    std::tuple<Matrix, Matrix, Matrix> svdResult = svd(centeredCords, SVD_NO_U);
+    Matrix Sigma = std::get<1>(svdResult);
+    Matrix V = std::get<2>(svdResult);
+    LOG_MATRIX(LOG_MODULE_TRILATERATION, LOG_LEVEL_TRACE, "Sigma:", Sigma);
+    LOG_MATRIX(LOG_MODULE_TRILATERATION, LOG_LEVEL_TRACE, "V:", V);
+
+    Matrix solveCords = centeredCords;
+    if (Dims == 3 && isCoplanar(Sigma))
+    {
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Warning: The points are coplanar. Assuming target is on the plane.");
+
+        // The plane basis is the first two columns of V, normalized in place.
+        // It is orthogonal to the plane normal, so the coordinates in it are
+        // those of the points projected onto the plane.
+        ColumnView planeU = V.column(0);
+        ColumnView planeV = V.column(1);
+        float normU = planeU.norm();
+        float normV = planeV.norm();
+        for (int j = 0; j < Dims; ++j)
+        {
+            planeU[j] /= normU;
+            planeV[j] /= normV;
+            basis[j][0] = planeU[j];
+            basis[j][1] = planeV[j];
+            basis[j][Dims - 1] = 0;
+        }
+        solveCords = convert3DTo2D(centeredCords, planeU, planeV);
+        solveDims = 2;
+        LOG_MATRIX(LOG_MODULE_TRILATERATION, LOG_LEVEL_TRACE, "Projected 2D Points:", solveCords);
+    }
+
+    // With zero ranges the right-hand side is just its geometry part
+    Matrix zeroDistances(count, 1);
+    std::pair<Matrix, Matrix> equations = computeEquations(solveCords, zeroDistances.column(0));
+    const Matrix &A = equations.first;
+    for (int i = 0; i < count - 1; ++i)
+    {
+        offset[i] = equations.second[i][0];
+    }
+
+    // Column i of the pseudo-inverse solves A x = e_i; one [A | b] buffer is reused for all of them
+    Matrix Ab(count - 1, solveDims + 1);
+    Matrix x(1, solveDims);
+    LeastSquaresInfo lsInfo;
+    for (int i = 0; i < count - 1; ++i)
+    {
+        copy(A, Ab.block(0, 0, count - 1, solveDims));
+        for (int r = 0; r < count - 1; ++r)
+        {
+            Ab[r][solveDims] = (r == i) ? 1 : 0;
+        }
+        if (!householderLeastSquaresInPlace(Ab, x.view().transpose(), &lsInfo))
+        {
+            LOG_WARN(LOG_MODULE_TRILATERATION, "Warning: Least squares failed (%s). Ignoring updates until the anchors change.",
+                     trackingStatusString(TRACKING_RANK_DEFICIENT));
+            state = TRACKING_RANK_DEFICIENT;
+            return;
+        }
+        for (int s = 0; s < solveDims; ++s)
+        {
+            pseudoInverse[s][i] = x[0][s];
+        }
+    }
+
+    // Any matrix operation above that failed has reported it
+    TrackingStatus status = takeTrackingError();
+    if (status != TRACKING_OK)
+    {
+        LOG_WARN(LOG_MODULE_TRILATERATION, "Warning: Matrix error (%s). Ignoring updates until the anchors change.", trackingStatusString(status));
+        state = status;
+        return;
+    }
+    LOG_DEBUG(LOG_MODULE_TRILATERATION, "Anchor geometry cached for %d anchors, condition estimate: %.1f", count, lsInfo.conditionEstimate);
+}
+
+/**
+ * @brief Compute a position from the ranges, rebuilding the cache if the anchor set changed.
+ *
+ * @param points Anchors with fresh ranges, in registry order
+ * @param count Number of anchors, at least Dims + 1
+ * @param position Output, Dims coordinates
+ * @return TrackingStatus TRACKING_OK, or why the anchor set gives no fix
+ */
+template <int Dims>
+TrackingStatus AnchorGeometry<Dims>::solve(const DataPoint *points, int count, float *position)
+{
+    if (count < Dims + 1)
+    {
+        return TRACKING_NOT_ENOUGH_POINTS;
+    }
+    if (!valid || count != this->count || hashAnchors(points, count) != key)
+    {
+        build(points, count);
+    }
+    if (state != TRACKING_OK)
+    {
+        return state;
+    }
+
+    // Right-hand side of the differenced equations
+    float b[MAX_ANCHORS - 1];
+    float d0Squared = points[0].d * points[0].d;
+    for (int i = 1; i < count; ++i)
+    {
+        b[i - 1] = (d0Squared - points[i].d * points[i].d) / 2 + offset[i - 1];
+    }
+
+    float y[Dims];
+    for (int s = 0; s < solveDims; ++s)
+    {
+        y[s] = 0;
+        for (int i = 0; i < count - 1; ++i)
+        {
+            y[s] += pseudoInverse[s][i] * b[i];
+        }
+    }
+    for (int j = 0; j < Dims; ++j)
+    {
+        position[j] = centroid[j];
+        for (int s = 0; s < solveDims; ++s)
+        {
+            position[j] += basis[j][s] * y[s];
+        }
+    }
+    return TRACKING_OK;
+}
+
+template class AnchorGeometry<2>;
+template class AnchorGeometry<3>;
@@ -0,0 +1,48 @@
+#ifndef ANCHOR_GEOMETRY_H
+#define ANCHOR_GEOMETRY_H
+
+#include "leastSquare.h"
+#include "anchorRegistry.h"
+#include "status.h"
+
+/**
+ * @brief Geometry-only products of the full least-squares solve, cached per anchor set.
+ *
+ * The differenced equations of the full solve,
+ *
+ *     (c_i - c_0) . x = (d_0^2 - d_i^2) / 2 + (|c_i|^2 - |c_0|^2) / 2,
+ *
+ * only involve the ranges on the right-hand side. With the centroid, the SVD
+ * and its degeneracy checks, the plane basis and the pseudo-inverse of A kept
+ * from the last anchor set, a fix is one (k - 1)-vector and one small
+ * matrix-vector multiply. The cache is keyed by a hash of the anchor
+ * coordinates and rebuilt when the set of anchors with fresh ranges changes.
+ *
+ * @tparam Dims Number of dimensions (2 for 2D, 3 for 3D)
+ */
+template <int Dims>
+class AnchorGeometry
+{
+public:
+    AnchorGeometry();
+
+    TrackingStatus solve(const DataPoint *points, int count, float *position);
+    void invalidate() { valid = false; }
+
+private:
+    static uint32_t hashAnchors(const DataPoint *points, int count);
+    void build(const DataPoint *points, int count);
+
+    uint32_t key;         // hashAnchors() of the cached anchor set
+    int count;            // Number of anchors in the cached set
+    bool valid;           // false until the first build
+    TrackingStatus state; // Why the cached set gives no fix, TRACKING_OK if it does
+    int solveDims;        // Dims, or 2 when 3D anchors are coplanar
+
+    float centroid[Dims];                       // Centroid of the anchors
+    float basis[Dims][Dims];                    // Columns map solve coordinates back to space
+    float offset[MAX_ANCHORS - 1];              // (|c_i|^2 - |c_0|^2) / 2 in solve coordinates
+    float pseudoInverse[Dims][MAX_ANCHORS - 1]; // Least-squares solution operator of A
+};
+
+#endif // ANCHOR_GEOMETRY_H
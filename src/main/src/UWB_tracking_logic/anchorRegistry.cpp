@@ -0,0 +1,287 @@
+#include "anchorRegistry.h"
+
+static const uint16_t FIRST_LOCAL_ID = 0xF000;    // Local IDs count up from here
+static const float POSITION_TOLERANCE = 1e-3f;    // Coordinates closer than this are the same anchor
+
+/**
+ * @brief Create an empty registry.
+ *
+ * @param storage Room for the entries, owned by the AnchorTable
+ * @param capacity Number of entries in storage
+ * @param maxAgeMs Ranges older than this are expired
+ * @param smoothing Weight of the previous average in [0, 1); 0 uses only the latest range
+ */
+AnchorRegistry::AnchorRegistry(AnchorEntry *storage, int capacity, unsigned long maxAgeMs, float smoothing)
+    : entries(storage), maxCount(capacity), count(0), maxAgeMs(maxAgeMs), smoothing(smoothing), nextLocalId(FIRST_LOCAL_ID),
+      changes(0)
+{
+}
+
+/**
+ * @brief Find the entry of an anchor
+ *
+ * @return AnchorEntry* The entry, or nullptr if the anchor is unknown
+ */
+AnchorEntry *AnchorRegistry::find(uint16_t id)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (entries[i].id == id)
+        {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Find the entry of an anchor (read-only)
+ */
+const AnchorEntry *AnchorRegistry::findAnchor(uint16_t id) const
+{
+    return const_cast<AnchorRegistry *>(this)->find(id);
+}
+
+/**
+ * @brief Take a free entry, or evict the one with the oldest range when full
+ */
+AnchorEntry *AnchorRegistry::allocate(uint16_t id)
+{
+    AnchorEntry *entry;
+    if (count < maxCount)
+    {
+        entry = &entries[count++];
+    }
+    else
+    {
+        entry = &entries[0];
+        for (int i = 1; i < count; ++i)
+        {
+            unsigned long age = entries[i].hasRange ? entries[i].timestamp : 0;
+            unsigned long oldest = entry->hasRange ? entry->timestamp : 0;
+            if (age < oldest)
+            {
+                entry = &entries[i];
+            }
+        }
+    }
+    entry->id = id;
+    entry->hasRange = false;
+    entry->range = 0;
+    entry->averageRange = 0;
+    entry->timestamp = 0;
+    entry->inlier = true;
+    return entry;
+}
+
+/**
+ * @brief Register an anchor or move an existing one.
+ *
+ * Moving an anchor drops its range, since it was measured to the old position.
+ *
+ * @param id Short address of the anchor
+ * @param x, y, z Coordinates of the anchor
+ * @return true if the anchor was added or moved, false if it is already there
+ */
+bool AnchorRegistry::setAnchor(uint16_t id, float x, float y, float z)
+{
+    AnchorEntry *entry = find(id);
+    if (entry && entry->x == x && entry->y == y && entry->z == z)
+    {
+        return false;
+    }
+    if (!entry)
+    {
+        entry = allocate(id);
+    }
+    entry->x = x;
+    entry->y = y;
+    entry->z = z;
+    entry->hasRange = false;
+    ++changes;
+    return true;
+}
+
+/**
+ * @brief Remove an anchor and its range
+ *
+ * @return true if the anchor was registered
+ */
+bool AnchorRegistry::removeAnchor(uint16_t id)
+{
+    AnchorEntry *entry = find(id);
+    if (!entry)
+    {
+        return false;
+    }
+    *entry = entries[--count];
+    ++changes;
+    return true;
+}
+
+/**
+ * @brief Remove every anchor
+ */
+void AnchorRegistry::clear()
+{
+    count = 0;
+    ++changes;
+}
+
+/**
+ * @brief Record a range to a registered anchor.
+ *
+ * @param id Short address of the anchor
+ * @param range Measured distance
+ * @param now Current time in milliseconds
+ * @return true on success, false if the anchor is not registered
+ */
+bool AnchorRegistry::addRange(uint16_t id, float range, unsigned long now)
+{
+    AnchorEntry *entry = find(id);
+    if (!entry)
+    {
+        return false;
+    }
+
+    if (smoothing > 0 && isFresh(*entry, now))
+    {
+        entry->averageRange = smoothing * entry->averageRange + (1 - smoothing) * range;
+    }
+    else
+    {
+        entry->averageRange = range;
+    }
+    entry->range = range;
+    entry->timestamp = now;
+    entry->hasRange = true;
+    return true;
+}
+
+/**
+ * @brief Record a range to the anchor at the point's coordinates.
+ *
+ * For input that carries coordinates but no anchor ID; an anchor not seen
+ * before is registered under a local ID.
+ *
+ * @param point Anchor coordinates and measured distance
+ * @param now Current time in milliseconds
+ * @param id Optional output, the ID the anchor is registered under
+ * @return true on success
+ */
+bool AnchorRegistry::addRange(const DataPoint &point, unsigned long now, uint16_t *id)
+{
+    AnchorEntry *entry = nullptr;
+    for (int i = 0; i < count; ++i)
+    {
+        if (fabs(entries[i].x - point.x) < POSITION_TOLERANCE &&
+            fabs(entries[i].y - point.y) < POSITION_TOLERANCE &&
+            fabs(entries[i].z - point.z) < POSITION_TOLERANCE)
+        {
+            entry = &entries[i];
+            break;
+        }
+    }
+
+    if (!entry)
+    {
+        while (find(nextLocalId))
+        {
+            nextLocalId = nextLocalId == 0xFFFF ? FIRST_LOCAL_ID : nextLocalId + 1;
+        }
+        setAnchor(nextLocalId, point.x, point.y, point.z);
+        entry = find(nextLocalId);
+    }
+    if (id)
+    {
+        *id = entry->id;
+    }
+    return addRange(entry->id, point.d, now);
+}
+
+/**
+ * @brief Whether an entry holds a range younger than the maximum age
+ */
+bool AnchorRegistry::isFresh(const AnchorEntry &entry, unsigned long now) const
+{
+    return entry.hasRange && now - entry.timestamp <= maxAgeMs;
+}
+
+/**
+ * @brief Drop ranges older than the maximum age (the anchors stay registered)
+ *
+ * @param now Current time in milliseconds
+ */
+void AnchorRegistry::expire(unsigned long now)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (!isFresh(entries[i], now))
+        {
+            entries[i].hasRange = false;
+        }
+    }
+}
+
+/**
+ * @brief Copy every anchor with a fresh range, one row per anchor.
+ *
+ * @param out Destination array
+ * @param capacity Size of the destination array
+ * @param now Current time in milliseconds
+ * @param ids Optional output, the anchor ID of each point
+ * @return int Number of points written
+ */
+int AnchorRegistry::collect(DataPoint *out, int capacity, unsigned long now, uint16_t *ids) const
+{
+    int n = 0;
+    for (int i = 0; i < count && n < capacity; ++i)
+    {
+        const AnchorEntry &entry = entries[i];
+        if (isFresh(entry, now))
+        {
+            if (ids)
+            {
+                ids[n] = entry.id;
+            }
+            out[n++] = {entry.x, entry.y, entry.z, entry.averageRange};
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Flag whether the range of an anchor agreed with the latest fix
+ */
+void AnchorRegistry::setInlier(uint16_t id, bool inlier)
+{
+    AnchorEntry *entry = find(id);
+    if (entry)
+    {
+        entry->inlier = inlier;
+    }
+}
+
+/**
+ * @brief Print the anchor table
+ *
+ * @param now Current time in milliseconds, for the age column
+ */
+void AnchorRegistry::print(unsigned long now) const
+{
+    Serial.printf("Anchors: %d / %d, max age %lu ms\n", count, maxCount, maxAgeMs);
+    for (int i = 0; i < count; ++i)
+    {
+        const AnchorEntry &entry = entries[i];
+        Serial.printf("Anchor %04X: x=%.2f, y=%.2f, z=%.2f", entry.id, entry.x, entry.y, entry.z);
+        if (isFresh(entry, now))
+        {
+            Serial.printf(", d=%.2f (avg %.2f), age %lu ms%s\n", entry.range, entry.averageRange, now - entry.timestamp,
+                          entry.inlier ? "" : ", outlier");
+        }
+        else
+        {
+            Serial.println(", no fresh range");
+        }
+    }
+}
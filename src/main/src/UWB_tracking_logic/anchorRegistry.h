@@ -0,0 +1,111 @@
+#ifndef ANCHOR_REGISTRY_H
+#define ANCHOR_REGISTRY_H
+
+#include <Arduino.h>
+
+#ifndef MAX_ANCHORS
+#define MAX_ANCHORS 16 // Anchors a tracker holds ranges to at once
+#endif
+
+#ifndef SITE_MAX_ANCHORS
+#define SITE_MAX_ANCHORS 128 // Anchors registered with a tracker pool, shared by its trackers
+#endif
+
+#ifndef RANGE_MAX_AGE_MS
+#define RANGE_MAX_AGE_MS 5000 // Ranges older than this are not used for a fix
+#endif
+
+struct DataPoint
+{
+    float x, y, z;  // Coordinates of the anchor point
+    float d;        // Distance to the target
+};
+
+/**
+ * @brief One anchor: its coordinates and the latest range to it.
+ */
+struct AnchorEntry
+{
+    uint16_t id;             // Short address of the anchor
+    float x, y, z;           // Coordinates of the anchor
+    float range;             // Latest measured range
+    float averageRange;      // Exponentially smoothed range
+    unsigned long timestamp; // millis() of the latest range
+    bool hasRange;           // false until a range arrives or after it expires
+    bool inlier;             // The range agreed with the latest robust fix
+};
+
+/**
+ * @brief Table of anchors keyed by ID, holding the latest (optionally
+ * smoothed) range per anchor, over storage owned by an AnchorTable.
+ *
+ * Coordinates are stored once per anchor and repeated reports from the same
+ * anchor overwrite its range instead of adding rows, so a fix is computed from
+ * unique anchors only. Ranges older than the maximum age are expired. When the
+ * table is full, a new anchor replaces the one with the oldest range.
+ */
+class AnchorRegistry
+{
+public:
+    AnchorRegistry(const AnchorRegistry &) = delete; // The entries belong to the AnchorTable
+    AnchorRegistry &operator=(const AnchorRegistry &) = delete;
+
+    bool setAnchor(uint16_t id, float x, float y, float z);
+    bool removeAnchor(uint16_t id);
+    const AnchorEntry *findAnchor(uint16_t id) const;
+
+    bool addRange(uint16_t id, float range, unsigned long now);
+    bool addRange(const DataPoint &point, unsigned long now, uint16_t *id = nullptr);
+    void expire(unsigned long now);
+    int collect(DataPoint *out, int capacity, unsigned long now, uint16_t *ids = nullptr) const;
+    void setInlier(uint16_t id, bool inlier);
+
+    int size() const { return count; }
+    int capacity() const { return maxCount; }
+    const AnchorEntry &entry(int index) const { return entries[index]; }
+    bool isFresh(const AnchorEntry &entry, unsigned long now) const;
+    unsigned long maxAge() const { return maxAgeMs; }
+    void setMaxAge(unsigned long ageMs) { maxAgeMs = ageMs; }
+    void setSmoothing(float factor) { smoothing = factor; }
+    void clear();
+    uint32_t revision() const { return changes; }
+    void print(unsigned long now) const;
+
+protected:
+    AnchorRegistry(AnchorEntry *storage, int capacity, unsigned long maxAgeMs, float smoothing);
+
+private:
+    AnchorEntry *find(uint16_t id);
+    AnchorEntry *allocate(uint16_t id);
+
+    AnchorEntry *entries;
+    int maxCount;
+    int count;
+    unsigned long maxAgeMs;
+    float smoothing;         // Weight of the previous average, 0 keeps only the latest range
+    uint16_t nextLocalId;    // IDs handed to anchors known only by their coordinates
+    uint32_t changes;        // Bumped whenever an anchor is added, moved or removed
+};
+
+/**
+ * @brief Anchor registry with room for Capacity anchors.
+ *
+ * Trackers keep a window of MAX_ANCHORS anchors they currently range to; a
+ * site (see TrackerPool) registers up to SITE_MAX_ANCHORS.
+ *
+ * @tparam Capacity Number of anchors
+ */
+template <int Capacity = MAX_ANCHORS>
+class AnchorTable : public AnchorRegistry
+{
+public:
+    AnchorTable(unsigned long maxAgeMs = RANGE_MAX_AGE_MS, float smoothing = 0)
+        : AnchorRegistry(storage, Capacity, maxAgeMs, smoothing)
+    {
+    }
+
+private:
+    AnchorEntry storage[Capacity];
+};
+
+#endif // ANCHOR_REGISTRY_H
@@ -0,0 +1,321 @@
+#include "anchorSelector.h"
+#include "arena.h"
+#include <algorithm>
+
+static const float GDOP_REGULARIZATION = 1e-3f; // Keeps directions no anchor constrains invertible
+static const float GDOP_UNDEFINED = 1e6f;       // Reported when the geometry matrix cannot be factorized
+
+/**
+ * @brief Geometric dilution of precision of a set of anchors seen from a point.
+ *
+ * With u_i the unit vectors from the anchors to the point, GDOP is
+ * sqrt(trace((H^T H)^-1)) for H = [u_i^T]; a small multiple of the identity
+ * is added to H^T H so subsets that leave a direction unconstrained still
+ * compare, with a large value.
+ *
+ * @param points Anchor coordinates
+ * @param indices Indices into points of the subset
+ * @param n Size of the subset
+ * @param at Point the precision is evaluated at (Dims coordinates)
+ * @return float GDOP, lower is better
+ */
+template <int Dims>
+float AnchorSelector<Dims>::dilution(const DataPoint *points, const int *indices, int n, const float *at)
+{
+    FixedMatrix<Dims, Dims> HtH = FixedMatrix<Dims, Dims>::identity(GDOP_REGULARIZATION);
+    for (int i = 0; i < n; ++i)
+    {
+        const DataPoint &anchor = points[indices[i]];
+        const float p[3] = {anchor.x, anchor.y, anchor.z};
+        float u[Dims];
+        float distanceSquared = 0;
+        for (int j = 0; j < Dims; ++j)
+        {
+            u[j] = at[j] - p[j];
+            distanceSquared += u[j] * u[j];
+        }
+        if (distanceSquared <= 0)
+        {
+            continue;
+        }
+        for (int j = 0; j < Dims; ++j)
+        {
+            for (int k = 0; k < Dims; ++k)
+            {
+                HtH(j, k) += u[j] * u[k] / distanceSquared;
+            }
+        }
+    }
+
+    Cholesky<FixedMatrix<Dims, Dims>> cholesky(HtH);
+    if (!cholesky.success())
+    {
+        return GDOP_UNDEFINED;
+    }
+    FixedMatrix<Dims, Dims> covariance = cholesky.solve(FixedMatrix<Dims, Dims>::identity());
+    float trace = 0;
+    for (int j = 0; j < Dims; ++j)
+    {
+        trace += covariance(j, j);
+    }
+    return sqrtf(trace);
+}
+
+/**
+ * @brief Create a selector over an anchor table; the grid is built on first use.
+ *
+ * @param source Anchor table, which must outlive the selector
+ */
+template <int Dims>
+AnchorSelector<Dims>::AnchorSelector(const AnchorRegistry &source)
+    : source(&source), built(false), builtRevision(0), originX(0), originY(0), cellSize(ANCHOR_GRID_CELL_SIZE), columns(0), rows(0)
+{
+}
+
+/**
+ * @brief Grid cell of a horizontal position, clamped to the grid
+ */
+template <int Dims>
+void AnchorSelector<Dims>::cellOf(float x, float y, int &column, int &row) const
+{
+    column = std::min(std::max((int)floorf((x - originX) / cellSize), 0), columns - 1);
+    row = std::min(std::max((int)floorf((y - originY) / cellSize), 0), rows - 1);
+}
+
+/**
+ * @brief Choose up to ANCHOR_SELECT_COUNT candidates greedily, each time adding
+ * the one that gives the lowest GDOP together with those already chosen
+ *
+ * @param chosen Output, indices into points
+ * @param gdop Optional output, GDOP of the chosen subset
+ * @return int Number of anchors chosen
+ */
+template <int Dims>
+int AnchorSelector<Dims>::greedy(const DataPoint *points, const int *candidates, int n, const float *at, int *chosen,
+                                 float *gdop) const
+{
+    int k = std::min(n, ANCHOR_SELECT_COUNT);
+    bool used[SITE_MAX_ANCHORS] = {false};
+    float best = GDOP_UNDEFINED;
+    for (int s = 0; s < k; ++s)
+    {
+        int bestCandidate = -1;
+        for (int c = 0; c < n; ++c)
+        {
+            if (used[c])
+            {
+                continue;
+            }
+            chosen[s] = candidates[c];
+            float value = dilution(points, chosen, s + 1, at);
+            if (bestCandidate < 0 || value < best)
+            {
+                best = value;
+                bestCandidate = c;
+            }
+        }
+        chosen[s] = candidates[bestCandidate];
+        used[bestCandidate] = true;
+    }
+    if (gdop)
+    {
+        *gdop = best;
+    }
+    return k;
+}
+
+/**
+ * @brief Rebuild the grid and the per-cell subsets from the registered anchors.
+ *
+ * The cell size starts at ANCHOR_GRID_CELL_SIZE and grows until the bounding
+ * box of the anchors fits in ANCHOR_GRID_MAX_CELLS cells. Each cell's subset
+ * is chosen from the anchors in the nearest ring of cells that holds enough of
+ * them, evaluated at the cell centre at the mean anchor height. The per-anchor
+ * temporaries grow with the site, so they live in the tracking arena.
+ */
+template <int Dims>
+void AnchorSelector<Dims>::build()
+{
+    ArenaScope arenaScope(trackingArena);
+    const AnchorRegistry &registry = *source;
+    built = true;
+    builtRevision = registry.revision();
+
+    int n = registry.size();
+    ArenaVector<DataPoint> anchors(n);
+    float minX = 0, maxX = 0, minY = 0, maxY = 0, meanZ = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        const AnchorEntry &entry = registry.entry(i);
+        anchors[i] = {entry.x, entry.y, entry.z, 0};
+        minX = i == 0 ? entry.x : std::min(minX, entry.x);
+        maxX = i == 0 ? entry.x : std::max(maxX, entry.x);
+        minY = i == 0 ? entry.y : std::min(minY, entry.y);
+        maxY = i == 0 ? entry.y : std::max(maxY, entry.y);
+        meanZ += entry.z / n;
+    }
+
+    originX = minX;
+    originY = minY;
+    cellSize = ANCHOR_GRID_CELL_SIZE;
+    do
+    {
+        columns = (int)((maxX - minX) / cellSize) + 1;
+        rows = (int)((maxY - minY) / cellSize) + 1;
+        if (columns * rows > ANCHOR_GRID_MAX_CELLS)
+        {
+            cellSize *= 1.5f;
+        }
+    } while (columns * rows > ANCHOR_GRID_MAX_CELLS);
+
+    // Anchor indices sorted by cell (counting sort)
+    int cellStart[ANCHOR_GRID_MAX_CELLS + 1] = {0};
+    ArenaVector<int> anchorCell(n);
+    ArenaVector<int> members(n);
+    for (int i = 0; i < n; ++i)
+    {
+        int column, row;
+        cellOf(anchors[i].x, anchors[i].y, column, row);
+        anchorCell[i] = row * columns + column;
+        ++cellStart[anchorCell[i] + 1];
+    }
+    for (int c = 0; c < columns * rows; ++c)
+    {
+        cellStart[c + 1] += cellStart[c];
+    }
+    int fill[ANCHOR_GRID_MAX_CELLS];
+    std::copy(cellStart, cellStart + columns * rows, fill);
+    for (int i = 0; i < n; ++i)
+    {
+        members[fill[anchorCell[i]]++] = i;
+    }
+
+    ArenaVector<int> candidates(n);
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int column = 0; column < columns; ++column)
+        {
+            // Widen the ring of cells until it holds enough anchors or covers the grid
+            int candidateCount = 0;
+            for (int ring = 1; candidateCount < ANCHOR_SELECT_COUNT && candidateCount < n; ++ring)
+            {
+                candidateCount = 0;
+                for (int r = std::max(row - ring, 0); r <= std::min(row + ring, rows - 1); ++r)
+                {
+                    for (int c = std::max(column - ring, 0); c <= std::min(column + ring, columns - 1); ++c)
+                    {
+                        int cell = r * columns + c;
+                        for (int m = cellStart[cell]; m < cellStart[cell + 1]; ++m)
+                        {
+                            candidates[candidateCount++] = members[m];
+                        }
+                    }
+                }
+            }
+
+            const float centre[3] = {originX + (column + 0.5f) * cellSize, originY + (row + 0.5f) * cellSize, meanZ};
+            int chosen[ANCHOR_SELECT_COUNT];
+            int cell = row * columns + column;
+            cellCount[cell] = greedy(anchors.data(), candidates.data(), candidateCount, centre, chosen, nullptr);
+            for (int s = 0; s < cellCount[cell]; ++s)
+            {
+                cellAnchors[cell][s] = registry.entry(chosen[s]).id;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Reduce the fresh anchors to the ANCHOR_SELECT_COUNT with the best geometry.
+ *
+ * The chosen anchors are moved to the front of points and ids.
+ *
+ * @param estimate Current position estimate (Dims coordinates)
+ * @param points Anchors with fresh ranges, reordered in place
+ * @param ids Anchor ID of each point, reordered with them
+ * @param count Number of points
+ * @param gdop Optional output, GDOP of the chosen subset at the estimate
+ * @return int Number of anchors to use
+ */
+template <int Dims>
+int AnchorSelector<Dims>::select(const float *estimate, DataPoint *points, uint16_t *ids, int count, float *gdop)
+{
+    if (count <= ANCHOR_SELECT_COUNT)
+    {
+        return count;
+    }
+    if (!built || builtRevision != source->revision())
+    {
+        build();
+    }
+
+    int column, row;
+    cellOf(estimate[0], estimate[1], column, row);
+    int cell = row * columns + column;
+
+    // Fast path: the subset chosen for this cell, if all of it is fresh
+    int chosen[ANCHOR_SELECT_COUNT];
+    int k = cellCount[cell];
+    for (int s = 0; s < k; ++s)
+    {
+        chosen[s] = -1;
+        for (int i = 0; i < count; ++i)
+        {
+            if (ids[i] == cellAnchors[cell][s])
+            {
+                chosen[s] = i;
+                break;
+            }
+        }
+        if (chosen[s] < 0)
+        {
+            k = 0;
+        }
+    }
+
+    if (k == ANCHOR_SELECT_COUNT)
+    {
+        if (gdop)
+        {
+            *gdop = dilution(points, chosen, k, estimate);
+        }
+    }
+    else
+    {
+        // Greedy choice among the fresh anchors in the nearest ring of cells that holds enough
+        int candidates[MAX_ANCHORS];
+        int candidateCount = 0;
+        for (int ring = 1; candidateCount < ANCHOR_SELECT_COUNT; ++ring)
+        {
+            candidateCount = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                int c, r;
+                cellOf(points[i].x, points[i].y, c, r);
+                if (abs(c - column) <= ring && abs(r - row) <= ring)
+                {
+                    candidates[candidateCount++] = i;
+                }
+            }
+        }
+        k = greedy(points, candidates, candidateCount, estimate, chosen, gdop);
+    }
+
+    // Move the chosen anchors to the front
+    DataPoint selectedPoints[ANCHOR_SELECT_COUNT];
+    uint16_t selectedIds[ANCHOR_SELECT_COUNT];
+    for (int s = 0; s < k; ++s)
+    {
+        selectedPoints[s] = points[chosen[s]];
+        selectedIds[s] = ids[chosen[s]];
+    }
+    for (int s = 0; s < k; ++s)
+    {
+        points[s] = selectedPoints[s];
+        ids[s] = selectedIds[s];
+    }
+    return k;
+}
+
+template class AnchorSelector<2>;
+template class AnchorSelector<3>;
@@ -0,0 +1,60 @@
+#ifndef ANCHOR_SELECTOR_H
+#define ANCHOR_SELECTOR_H
+
+#include "fixedMatrix.h"
+#include "factorization.h"
+#include "anchorRegistry.h"
+
+#ifndef ANCHOR_SELECT_COUNT
+#define ANCHOR_SELECT_COUNT 6 // Anchors used per fix when more have fresh ranges
+#endif
+
+#ifndef ANCHOR_GRID_CELL_SIZE
+#define ANCHOR_GRID_CELL_SIZE 5.0f // Edge of a grid cell in metres, grown when the site needs more cells
+#endif
+
+#ifndef ANCHOR_GRID_MAX_CELLS
+#define ANCHOR_GRID_MAX_CELLS 64 // Cells in the grid over the anchor positions
+#endif
+
+/**
+ * @brief Picks the ANCHOR_SELECT_COUNT anchors with the lowest GDOP around the
+ * current estimate, so the cost of a fix does not grow with the site.
+ *
+ * Anchors are indexed by a uniform grid over their horizontal positions. For
+ * each cell the best subset at the cell centre is chosen once, when the
+ * anchors change; a fix whose estimate falls in a cell with all of that
+ * subset fresh takes it as is. Otherwise the subset is chosen greedily from
+ * the fresh anchors in the surrounding cells, by GDOP at the estimate.
+ *
+ * The grid depends only on the anchor positions, so one selector serves every
+ * tracker that shares a site; it follows the registry it was created with.
+ *
+ * @tparam Dims Number of dimensions (2 for 2D, 3 for 3D)
+ */
+template <int Dims>
+class AnchorSelector
+{
+public:
+    explicit AnchorSelector(const AnchorRegistry &source);
+
+    int select(const float *estimate, DataPoint *points, uint16_t *ids, int count,
+               float *gdop = nullptr);
+    static float dilution(const DataPoint *points, const int *indices, int n, const float *at);
+
+private:
+    void build();
+    void cellOf(float x, float y, int &column, int &row) const;
+    int greedy(const DataPoint *points, const int *candidates, int n, const float *at, int *chosen, float *gdop) const;
+
+    const AnchorRegistry *source; // Anchors the grid is built from
+    bool built;
+    uint32_t builtRevision;  // Registry revision the grid was built from
+    float originX, originY;  // Corner of cell (0, 0)
+    float cellSize;
+    int columns, rows;
+    uint16_t cellAnchors[ANCHOR_GRID_MAX_CELLS][ANCHOR_SELECT_COUNT]; // Best subset at each cell centre
+    uint8_t cellCount[ANCHOR_GRID_MAX_CELLS];
+};
+
+#endif // ANCHOR_SELECTOR_H
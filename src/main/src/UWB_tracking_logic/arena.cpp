@@ -0,0 +1,121 @@
+#include "arena.h"
+
+static const size_t ARENA_ALIGNMENT = 8;
+
+Arena *Arena::first = nullptr;
+Arena *Arena::current = nullptr;
+
+static uint8_t trackingArenaBuffer[TRACKING_ARENA_SIZE] __attribute__((aligned(ARENA_ALIGNMENT)));
+Arena trackingArena(trackingArenaBuffer, sizeof(trackingArenaBuffer));
+
+/**
+ * @brief Arena constructor.
+ *
+ * @param buffer Backing storage (must stay valid for the arena's lifetime)
+ * @param capacity Size of the backing storage in bytes
+ */
+Arena::Arena(void *buffer, size_t capacity)
+    : buffer(static_cast<uint8_t *>(buffer)), size(capacity), offset(0), peakOffset(0), overflowCount(0)
+{
+    next = first;
+    first = this;
+}
+
+/**
+ * @brief Arena destructor, unregisters the arena.
+ */
+Arena::~Arena()
+{
+    for (Arena **it = &first; *it; it = &(*it)->next)
+    {
+        if (*it == this)
+        {
+            *it = next;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Allocate memory from the arena.
+ *
+ * @param bytes Number of bytes to allocate
+ * @return void* Pointer to the memory, or nullptr if the arena is exhausted
+ */
+void *Arena::allocate(size_t bytes)
+{
+    size_t aligned = (bytes + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    if (aligned > size - offset)
+    {
+        overflowCount++;
+        return nullptr;
+    }
+
+    void *ptr = buffer + offset;
+    offset += aligned;
+    if (offset > peakOffset)
+        peakOffset = offset;
+    return ptr;
+}
+
+/**
+ * @brief Check whether a pointer lies inside the arena's buffer.
+ */
+bool Arena::owns(const void *ptr) const
+{
+    const uint8_t *p = static_cast<const uint8_t *>(ptr);
+    return p >= buffer && p < buffer + size;
+}
+
+/**
+ * @brief Release every allocation at once.
+ */
+void Arena::reset()
+{
+    offset = 0;
+}
+
+/**
+ * @brief Print the arena usage statistics
+ */
+void Arena::printStats() const
+{
+    Serial.printf("Arena: %u / %u bytes used, peak %u bytes, %lu overflows\n",
+                  (unsigned)offset, (unsigned)size, (unsigned)peakOffset, overflowCount);
+}
+
+/**
+ * @brief Find the arena a pointer was allocated from.
+ *
+ * @return Arena* The owning arena, or nullptr for heap memory
+ */
+Arena *Arena::owner(const void *ptr)
+{
+    for (Arena *arena = first; arena; arena = arena->next)
+    {
+        if (arena->owns(ptr))
+            return arena;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Open an arena scope.
+ *
+ * @param arena The arena that serves allocations inside the scope
+ */
+ArenaScope::ArenaScope(Arena &arena)
+    : arena(arena), previous(Arena::current)
+{
+    Arena::current = &arena;
+}
+
+/**
+ * @brief Close the scope, resetting the arena in O(1).
+ */
+ArenaScope::~ArenaScope()
+{
+    Arena::current = previous;
+    if (previous != &arena)
+        arena.reset();
+}
@@ -0,0 +1,113 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#ifndef TRACKING_ARENA_SIZE
+#define TRACKING_ARENA_SIZE 8192 // Bytes reserved for the temporaries of one localization cycle
+#endif
+
+/**
+ * @brief Bump allocator over a fixed buffer.
+ *
+ * Allocation is a pointer increment, deallocation is a no-op and reset()
+ * releases everything at once. When the buffer is exhausted, allocations fall
+ * back to the heap and are counted as overflows.
+ */
+class Arena
+{
+public:
+    Arena(void *buffer, size_t capacity);
+    ~Arena();
+
+    void *allocate(size_t bytes);
+    bool owns(const void *ptr) const;
+    void reset();
+
+    size_t used() const { return offset; }
+    size_t peak() const { return peakOffset; }
+    size_t capacity() const { return size; }
+    unsigned long overflows() const { return overflowCount; }
+    void printStats() const;
+
+    static Arena *active() { return current; }
+    static Arena *owner(const void *ptr);
+
+private:
+    uint8_t *buffer;
+    size_t size;
+    size_t offset;
+    size_t peakOffset;
+    unsigned long overflowCount;
+
+    Arena *next; // Registered arenas, so any pointer can be traced back to its owner
+    static Arena *first;
+    static Arena *current;
+
+    friend class ArenaScope;
+};
+
+/**
+ * @brief Makes an arena the target of ArenaAllocator for the lifetime of the
+ * scope and resets it on exit.
+ *
+ * Nothing allocated inside the scope may outlive it.
+ */
+class ArenaScope
+{
+public:
+    explicit ArenaScope(Arena &arena);
+    ~ArenaScope();
+
+private:
+    Arena &arena;
+    Arena *previous;
+};
+
+/**
+ * @brief Allocator that serves requests from the active arena, or from the
+ * heap when no ArenaScope is open.
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    ArenaAllocator() {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &) {}
+
+    T *allocate(size_t n)
+    {
+        Arena *arena = Arena::active();
+        if (arena)
+        {
+            void *ptr = arena->allocate(n * sizeof(T));
+            if (ptr)
+                return static_cast<T *>(ptr);
+        }
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, size_t)
+    {
+        if (!Arena::owner(ptr))
+            ::operator delete(ptr);
+    }
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &, const ArenaAllocator<U> &) { return true; }
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &, const ArenaAllocator<U> &) { return false; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+extern Arena trackingArena; // Shared by every localization cycle
+
+#endif // ARENA_H
@@ -0,0 +1,432 @@
+#include "benchmark.h"
+#include "matrix.h"
+#include "KalmanFilter.h"
+
+/**
+ * @brief Reference Kalman filter built on the dynamic Matrix class.
+ *
+ * Mirrors the heap-allocating implementation the fixed-size KalmanFilter
+ * replaced, so both can be timed on the same input.
+ */
+struct MatrixKalmanReference
+{
+    int n;
+    Matrix X, F, P, Q, H, R, I;
+
+    MatrixKalmanReference(int numOfDimensions)
+        : n(numOfDimensions),
+          X(numOfDimensions * 2, 1),
+          F(numOfDimensions * 2, numOfDimensions * 2),
+          P(numOfDimensions * 2, numOfDimensions * 2),
+          Q(numOfDimensions * 2, numOfDimensions * 2),
+          H(numOfDimensions, numOfDimensions * 2),
+          R(numOfDimensions, numOfDimensions),
+          I(numOfDimensions * 2, numOfDimensions * 2)
+    {
+        F.set_identity();
+        P.set_identity(10);
+        Q.set_identity();
+        H.set_identity();
+        R.set_identity(1);
+        I.set_identity();
+    }
+
+    void predict(float dt)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            F[i][i + n] = dt;
+        }
+        X = F * X;
+        P = F * P * F.transpose() + Q;
+    }
+
+    void update(const Matrix &measurement)
+    {
+        Matrix Y = measurement - (H * X);
+        Matrix S = H * P * H.transpose() + R;
+        Matrix K = P * H.transpose() * S.inverseQR();
+        X = X + K * Y;
+        P = (I - K * H) * P;
+    }
+};
+
+/**
+ * @brief Synthetic measurement for benchmark step i (slow circular motion)
+ */
+static void benchmarkMeasurement(int i, float *out)
+{
+    float t = i * 0.01f;
+    out[0] = 3.0f + 2.0f * cos(t);
+    out[1] = 2.0f + 2.0f * sin(t);
+    out[2] = 1.0f + 0.01f * (i % 7);
+}
+
+/**
+ * @brief Time Kalman predict+update with the dynamic Matrix reference and the
+ * fixed-size KalmanFilter<3>, and print the per-iteration cost over Serial.
+ *
+ * @param iterations Number of predict+update cycles per implementation
+ */
+void runTrackingBenchmark(int iterations)
+{
+    const float dt = 0.1f;
+    float z[3];
+
+    MatrixKalmanReference reference(3);
+    Matrix measurement(3, 1);
+    unsigned long start = micros();
+    for (int i = 0; i < iterations; ++i)
+    {
+        benchmarkMeasurement(i, z);
+        measurement[0][0] = z[0];
+        measurement[1][0] = z[1];
+        measurement[2][0] = z[2];
+        reference.predict(dt);
+        reference.update(measurement);
+    }
+    unsigned long dynamicTime = micros() - start;
+
+    KalmanFilter<3> kf;
+    KalmanFilter<3>::MeasurementVector fixedMeasurement;
+    start = micros();
+    for (int i = 0; i < iterations; ++i)
+    {
+        benchmarkMeasurement(i, z);
+        fixedMeasurement[0][0] = z[0];
+        fixedMeasurement[1][0] = z[1];
+        fixedMeasurement[2][0] = z[2];
+        kf.predict(dt);
+        kf.update(fixedMeasurement);
+    }
+    unsigned long fixedTime = micros() - start;
+
+    DecoupledKalmanFilter<3> decoupled;
+    start = micros();
+    for (int i = 0; i < iterations; ++i)
+    {
+        benchmarkMeasurement(i, z);
+        fixedMeasurement[0][0] = z[0];
+        fixedMeasurement[1][0] = z[1];
+        fixedMeasurement[2][0] = z[2];
+        decoupled.predict(dt);
+        decoupled.update(fixedMeasurement);
+    }
+    unsigned long decoupledTime = micros() - start;
+
+    // All filters see the same data, so their states should agree
+    KalmanFilter<3>::StateVector state = kf.getState();
+    DecoupledKalmanFilter<3>::StateVector decoupledState = decoupled.getState();
+    float maxDiff = 0;
+    float maxDecoupledDiff = 0;
+    for (int i = 0; i < 6; ++i)
+    {
+        maxDiff = std::max(maxDiff, (float)fabs(state[i][0] - reference.X[i][0]));
+        maxDecoupledDiff = std::max(maxDecoupledDiff, (float)fabs(decoupledState[i][0] - state[i][0]));
+    }
+
+    Serial.printf("Kalman predict+update, %d iterations\n", iterations);
+    Serial.printf("  Matrix (dynamic):   %.2f us/iter\n", (float)dynamicTime / iterations);
+    Serial.printf("  KalmanFilter<3>:    %.2f us/iter\n", (float)fixedTime / iterations);
+    Serial.printf("  Decoupled axes:     %.2f us/iter\n", (float)decoupledTime / iterations);
+    Serial.printf("  Max state difference: %g (decoupled vs fixed: %g)\n", maxDiff, maxDecoupledDiff);
+}
+
+/**
+ * @brief Deterministic pseudo-random value in [-amplitude, amplitude)
+ */
+static float benchmarkNoise(uint32_t &seed, float amplitude)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return amplitude * ((float)(seed >> 8) / 8388608.0f - 1.0f);
+}
+
+/**
+ * @brief Noisy position fix for step i, as the trilateration stage would feed
+ * the filter (the synthetic trajectory plus +-5 cm of measurement noise)
+ */
+static void noisyMeasurement(int i, uint32_t &seed, float *out)
+{
+    benchmarkMeasurement(i, out);
+    for (int j = 0; j < 3; ++j)
+    {
+        out[j] += benchmarkNoise(seed, 0.05f);
+    }
+}
+
+struct ScalarComparison
+{
+    float usPerIteration; // predict + update + adjustKalmanNoise
+    double maxError;      // Largest position deviation from the double filter
+    double rmsError;      // RMS position deviation from the double filter
+};
+
+/**
+ * @brief Time KalmanFilter<3, Scalar> and measure how far its position drifts
+ * from a double-precision filter fed the same measurements.
+ *
+ * The timed pass runs the filter alone; the accuracy pass runs it in lockstep
+ * with the reference.
+ */
+template <typename Scalar>
+static ScalarComparison compareScalar(int iterations)
+{
+    const float dt = 0.1f;
+    float z[3];
+    ScalarComparison result;
+
+    KalmanFilter<3, Scalar> kf;
+    typename KalmanFilter<3, Scalar>::MeasurementVector measurement;
+    uint32_t seed = 1;
+    unsigned long start = micros();
+    for (int i = 0; i < iterations; ++i)
+    {
+        noisyMeasurement(i, seed, z);
+        for (int j = 0; j < 3; ++j)
+        {
+            measurement[j][0] = z[j];
+        }
+        kf.predict(dt);
+        kf.update(measurement);
+        kf.adjustKalmanNoise();
+    }
+    result.usPerIteration = (float)(micros() - start) / iterations;
+
+    KalmanFilter<3, double> reference;
+    KalmanFilter<3, double>::MeasurementVector referenceMeasurement;
+    kf = KalmanFilter<3, Scalar>();
+    seed = 1;
+    double maxError = 0;
+    double sumSquares = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        noisyMeasurement(i, seed, z);
+        for (int j = 0; j < 3; ++j)
+        {
+            measurement[j][0] = z[j];
+            referenceMeasurement[j][0] = z[j];
+        }
+        kf.predict(dt);
+        kf.update(measurement);
+        kf.adjustKalmanNoise();
+        reference.predict(dt);
+        reference.update(referenceMeasurement);
+        reference.adjustKalmanNoise();
+
+        typename KalmanFilter<3, Scalar>::StateVector state = kf.getState();
+        KalmanFilter<3, double>::StateVector referenceState = reference.getState();
+        for (int j = 0; j < 3; ++j)
+        {
+            double error = fabs((double)state[j][0] - referenceState[j][0]);
+            maxError = std::max(maxError, error);
+            sumSquares += error * error;
+        }
+    }
+    result.maxError = maxError;
+    result.rmsError = sqrt(sumSquares / (3.0 * iterations));
+    return result;
+}
+
+/**
+ * @brief Compare the Kalman filter across scalar types (double, float,
+ * Q16.16, Q8.24) on synthetic noisy fixes and print speed and position error
+ * against the double filter over Serial.
+ *
+ * @param iterations Number of filter steps per scalar type
+ */
+void runScalarComparison(int iterations)
+{
+    ScalarComparison results[4] = {
+        compareScalar<double>(iterations),
+        compareScalar<float>(iterations),
+        compareScalar<Q16_16>(iterations),
+        compareScalar<Q8_24>(iterations),
+    };
+    const char *names[4] = {"double", "float", "Q16.16", "Q8.24"};
+
+    Serial.printf("KalmanFilter<3> by scalar type, %d iterations (error vs double)\n", iterations);
+    for (int i = 0; i < 4; ++i)
+    {
+        Serial.printf("  %-7s %7.2f us/iter  max %.2e m  rms %.2e m\n", names[i], results[i].usPerIteration,
+                      results[i].maxError, results[i].rmsError);
+    }
+}
+
+/**
+ * @brief Largest |P(i, j) - P(j, i)|
+ */
+template <typename Matrix>
+static float asymmetry(const Matrix &P)
+{
+    float largest = 0;
+    for (int i = 0; i < Matrix::Rows; ++i)
+    {
+        for (int j = i + 1; j < Matrix::Cols; ++j)
+        {
+            largest = std::max(largest, (float)fabs(P(i, j) - P(j, i)));
+        }
+    }
+    return largest;
+}
+
+/**
+ * @brief Soak run in progress, advanced by serviceFilterSoak()
+ */
+struct FilterSoak
+{
+    KalmanFilter<3> dense;
+    UDKalmanFilter<3> factored;
+    KalmanFilter<3, double> reference;
+    bool running;
+    long step, iterations;
+    uint32_t seed;
+    float denseUs, factoredUs;
+    double denseMax, factoredMax, denseError, factoredError;
+    float maxAsymmetry;
+    float minD;
+    long indefinite; // Covariance checks that failed the Cholesky factorization
+};
+
+static FilterSoak soak;
+
+/**
+ * @brief Start a long run of the dense and the UD-factorized float filters in
+ * lockstep with a double-precision reference.
+ *
+ * Only the timing passes run here; serviceFilterSoak() advances the run from
+ * the main loop and reports the result over Serial. A run in progress is
+ * restarted.
+ *
+ * @param iterations Number of filter steps (864000 is a day at 10 Hz)
+ */
+void startFilterSoak(long iterations)
+{
+    const float dt = 0.1f;
+    const int timedIterations = 1000;
+    float z[3];
+    KalmanFilter<3>::MeasurementVector measurement;
+
+    // Timed passes, each filter alone
+    soak.dense.reset();
+    soak.factored.reset();
+    uint32_t seed = 1;
+    unsigned long start = micros();
+    for (int i = 0; i < timedIterations; ++i)
+    {
+        noisyMeasurement(i, seed, z);
+        std::copy(z, z + 3, measurement.values);
+        soak.dense.predict(dt);
+        soak.dense.update(measurement);
+        soak.dense.adjustKalmanNoise();
+    }
+    soak.denseUs = (float)(micros() - start) / timedIterations;
+    seed = 1;
+    start = micros();
+    for (int i = 0; i < timedIterations; ++i)
+    {
+        noisyMeasurement(i, seed, z);
+        std::copy(z, z + 3, measurement.values);
+        soak.factored.predict(dt);
+        soak.factored.update(measurement);
+        soak.factored.adjustKalmanNoise();
+    }
+    soak.factoredUs = (float)(micros() - start) / timedIterations;
+
+    soak.dense.reset();
+    soak.factored.reset();
+    soak.reference.reset();
+    soak.running = iterations > 0;
+    soak.step = 0;
+    soak.iterations = iterations;
+    soak.seed = 1;
+    soak.denseMax = soak.factoredMax = soak.denseError = soak.factoredError = 0;
+    soak.maxAsymmetry = 0;
+    soak.minD = 0;
+    soak.indefinite = 0;
+    Serial.printf("Filter soak started, %ld steps\n", iterations);
+}
+
+/**
+ * @brief Advance a running soak by up to FILTER_SOAK_STEPS_PER_CALL steps.
+ *
+ * Each step compares the float positions with the double reference. The
+ * covariance of the dense filter is checked every 1000 steps for symmetry and,
+ * with a Cholesky factorization, positive definiteness. After the last step
+ * the result is printed over Serial: PASS if both float filters stayed within
+ * FILTER_SOAK_MAX_ERROR of the reference, the dense covariance stayed
+ * positive definite and the UD diagonal stayed positive.
+ *
+ * @return true while the soak is running
+ */
+bool serviceFilterSoak()
+{
+    if (!soak.running)
+    {
+        return false;
+    }
+
+    const float dt = 0.1f;
+    float z[3];
+    KalmanFilter<3>::MeasurementVector measurement;
+    KalmanFilter<3, double>::MeasurementVector referenceMeasurement;
+    long end = std::min(soak.step + FILTER_SOAK_STEPS_PER_CALL, soak.iterations);
+    for (; soak.step < end; ++soak.step)
+    {
+        noisyMeasurement(soak.step, soak.seed, z);
+        for (int j = 0; j < 3; ++j)
+        {
+            measurement[j][0] = z[j];
+            referenceMeasurement[j][0] = z[j];
+        }
+        soak.dense.predict(dt);
+        soak.dense.update(measurement);
+        soak.dense.adjustKalmanNoise();
+        soak.factored.predict(dt);
+        soak.factored.update(measurement);
+        soak.factored.adjustKalmanNoise();
+        soak.reference.predict(dt);
+        soak.reference.update(referenceMeasurement);
+        soak.reference.adjustKalmanNoise();
+
+        KalmanFilter<3>::StateVector denseState = soak.dense.getState();
+        UDKalmanFilter<3>::StateVector factoredState = soak.factored.getState();
+        KalmanFilter<3, double>::StateVector referenceState = soak.reference.getState();
+        soak.denseError = 0;
+        soak.factoredError = 0;
+        for (int j = 0; j < 3; ++j)
+        {
+            soak.denseError = std::max(soak.denseError, fabs((double)denseState[j][0] - referenceState[j][0]));
+            soak.factoredError = std::max(soak.factoredError, fabs((double)factoredState[j][0] - referenceState[j][0]));
+        }
+        soak.denseMax = std::max(soak.denseMax, soak.denseError);
+        soak.factoredMax = std::max(soak.factoredMax, soak.factoredError);
+
+        soak.minD = soak.step == 0 ? soak.factored.minDiagonal() : std::min(soak.minD, soak.factored.minDiagonal());
+        if (soak.step % 1000 == 999)
+        {
+            KalmanFilter<3>::Snapshot snapshot;
+            soak.dense.save(snapshot);
+            soak.maxAsymmetry = std::max(soak.maxAsymmetry, asymmetry(snapshot.P));
+            Cholesky<KalmanFilter<3>::StateMatrix> cholesky(snapshot.P);
+            if (!cholesky.success())
+            {
+                ++soak.indefinite;
+            }
+        }
+    }
+    if (soak.step < soak.iterations)
+    {
+        return true;
+    }
+
+    soak.running = false;
+    bool passed = soak.denseMax <= FILTER_SOAK_MAX_ERROR && soak.factoredMax <= FILTER_SOAK_MAX_ERROR &&
+                  soak.indefinite == 0 && soak.minD > 0;
+    Serial.printf("Filter soak, %ld steps (position error vs double)\n", soak.iterations);
+    Serial.printf("  dense float: %6.2f us/iter  max %.2e m  final %.2e m  asymmetry %.2e  indefinite %ld checks\n",
+                  soak.denseUs, soak.denseMax, soak.denseError, soak.maxAsymmetry, soak.indefinite);
+    Serial.printf("  UD float:    %6.2f us/iter  max %.2e m  final %.2e m  min D %.2e\n", soak.factoredUs, soak.factoredMax,
+                  soak.factoredError, soak.minD);
+    Serial.printf("Filter soak %s (limit %.0e m)\n", passed ? "PASS" : "FAIL", FILTER_SOAK_MAX_ERROR);
+    return false;
+}
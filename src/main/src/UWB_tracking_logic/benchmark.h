@@ -0,0 +1,19 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+
+#ifndef FILTER_SOAK_STEPS_PER_CALL
+#define FILTER_SOAK_STEPS_PER_CALL 100 // Soak steps per serviceFilterSoak() call, so the main loop keeps servicing the radio
+#endif
+
+#ifndef FILTER_SOAK_MAX_ERROR
+#define FILTER_SOAK_MAX_ERROR 1e-3 // Position error (m) against the double reference above which the soak fails
+#endif
+
+void runTrackingBenchmark(int iterations = 1000);
+void runScalarComparison(int iterations = 1000);
+void startFilterSoak(long iterations = 100000);
+bool serviceFilterSoak();
+
+#endif // BENCHMARK_H
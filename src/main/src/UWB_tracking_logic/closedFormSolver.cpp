@@ -0,0 +1,159 @@
+#include "closedFormSolver.h"
+#include <algorithm>
+
+static const float MIN_BASELINE = 1e-3f; // Anchors closer than this (metres) do not span an axis
+
+/**
+ * @brief Distance from a candidate to an anchor minus the measured range, over the first Dims coordinates
+ */
+template <int Dims>
+static float rangeResidual(const float *candidate, const DataPoint &anchor)
+{
+    const float p[3] = {anchor.x, anchor.y, anchor.z};
+    float distanceSquared = 0;
+    for (int j = 0; j < Dims; ++j)
+    {
+        float delta = candidate[j] - p[j];
+        distanceSquared += delta * delta;
+    }
+    return fabsf(sqrtf(distanceSquared) - anchor.d);
+}
+
+/**
+ * @brief Position from the minimal anchor set in closed form.
+ *
+ * The first Dims anchors span a local frame: ex along anchors 0 -> 1, ey
+ * towards anchor 2 (3D only) and a normal axis. Subtracting the sphere (circle)
+ * equations pairwise gives the in-frame coordinates directly,
+ *
+ *     x = (r0^2 - r1^2 + d^2) / (2 d)
+ *     y = (r0^2 - r2^2 + i^2 + j^2) / (2 j) - x i / j    (3D)
+ *
+ * and the normal coordinate is +-sqrt(r0^2 - x^2 - y^2), clamped at zero when
+ * noisy ranges leave no intersection. The remaining anchor picks the sign; when
+ * it cannot (it lies on the frame's line or plane), the one nearer the previous
+ * position is taken.
+ *
+ * @param points Exactly Dims + 1 anchors with ranges
+ * @param count Number of anchors
+ * @param position Output, Dims coordinates
+ * @param previous Optional previous position (Dims coordinates) for the mirror ambiguity
+ * @return TrackingStatus TRACKING_OK; TRACKING_COLLINEAR if the first anchors do
+ *         not span a frame; TRACKING_RANK_DEFICIENT if the mirror solutions cannot be told apart
+ */
+template <int Dims>
+TrackingStatus solveClosedForm(const DataPoint *points, int count, float *position, const float *previous)
+{
+    if (count != Dims + 1)
+    {
+        return count < Dims + 1 ? TRACKING_NOT_ENOUGH_POINTS : TRACKING_DIMENSION_MISMATCH;
+    }
+
+    // Work in three components; 2D points get z = 0
+    float p[Dims + 1][3];
+    for (int i = 0; i < count; ++i)
+    {
+        p[i][0] = points[i].x;
+        p[i][1] = points[i].y;
+        p[i][2] = Dims == 3 ? points[i].z : 0;
+    }
+
+    // ex along anchors 0 -> 1
+    float ex[3], ey[3] = {0, 0, 0}, normal[3];
+    float d = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+        ex[k] = p[1][k] - p[0][k];
+        d += ex[k] * ex[k];
+    }
+    d = sqrtf(d);
+    if (d < MIN_BASELINE)
+    {
+        return TRACKING_COLLINEAR;
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+        ex[k] /= d;
+    }
+
+    float r0Squared = points[0].d * points[0].d;
+    float x = (r0Squared - points[1].d * points[1].d + d * d) / (2 * d);
+    float y = 0;
+
+    if (Dims == 2)
+    {
+        normal[0] = -ex[1];
+        normal[1] = ex[0];
+        normal[2] = 0;
+    }
+    else
+    {
+        // ey towards anchor 2, orthogonal to ex
+        float i = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            i += ex[k] * (p[2][k] - p[0][k]);
+        }
+        float j = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            ey[k] = p[2][k] - p[0][k] - i * ex[k];
+            j += ey[k] * ey[k];
+        }
+        j = sqrtf(j);
+        if (j < MIN_BASELINE)
+        {
+            return TRACKING_COLLINEAR;
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            ey[k] /= j;
+        }
+        normal[0] = ex[1] * ey[2] - ex[2] * ey[1];
+        normal[1] = ex[2] * ey[0] - ex[0] * ey[2];
+        normal[2] = ex[0] * ey[1] - ex[1] * ey[0];
+
+        y = (r0Squared - points[2].d * points[2].d + i * i + j * j) / (2 * j) - x * i / j;
+    }
+
+    float h = sqrtf(std::max(r0Squared - x * x - y * y, 0.0f));
+
+    // The two mirror solutions, either side of the frame's line (2D) or plane (3D)
+    float candidates[2][3];
+    for (int k = 0; k < 3; ++k)
+    {
+        float base = p[0][k] + x * ex[k] + y * ey[k];
+        candidates[0][k] = base + h * normal[k];
+        candidates[1][k] = base - h * normal[k];
+    }
+
+    // The extra anchor decides, unless it sits on the mirror line or plane.
+    // Candidates closer together than the margin are both acceptable.
+    const DataPoint &extra = points[Dims];
+    float residual0 = rangeResidual<Dims>(candidates[0], extra);
+    float residual1 = rangeResidual<Dims>(candidates[1], extra);
+    int chosen = residual0 <= residual1 ? 0 : 1;
+    if (fabsf(residual0 - residual1) < CLOSED_FORM_MIRROR_MARGIN && 2 * h > CLOSED_FORM_MIRROR_MARGIN)
+    {
+        if (!previous)
+        {
+            return TRACKING_RANK_DEFICIENT;
+        }
+        float distance0 = 0, distance1 = 0;
+        for (int k = 0; k < Dims; ++k)
+        {
+            distance0 += (candidates[0][k] - previous[k]) * (candidates[0][k] - previous[k]);
+            distance1 += (candidates[1][k] - previous[k]) * (candidates[1][k] - previous[k]);
+        }
+        chosen = distance0 <= distance1 ? 0 : 1;
+    }
+
+    for (int k = 0; k < Dims; ++k)
+    {
+        position[k] = candidates[chosen][k];
+    }
+    return TRACKING_OK;
+}
+
+template TrackingStatus solveClosedForm<2>(const DataPoint *, int, float *, const float *);
+template TrackingStatus solveClosedForm<3>(const DataPoint *, int, float *, const float *);
@@ -0,0 +1,14 @@
+#ifndef CLOSED_FORM_SOLVER_H
+#define CLOSED_FORM_SOLVER_H
+
+#include "anchorRegistry.h"
+#include "status.h"
+
+#ifndef CLOSED_FORM_MIRROR_MARGIN
+#define CLOSED_FORM_MIRROR_MARGIN 0.1f // Range residual difference (metres) below which the extra anchor cannot pick the mirror solution
+#endif
+
+template <int Dims>
+TrackingStatus solveClosedForm(const DataPoint *points, int count, float *position, const float *previous = nullptr);
+
+#endif // CLOSED_FORM_SOLVER_H
@@ -0,0 +1,409 @@
+#include "factorization.h"
+
+/*
+ * The systems factored here are tiny (the 2x2/3x3 innovation covariance, the
+ * R factor of a 3-column least-squares problem), so the inner products are
+ * plain loops the compiler can inline rather than calls into the kernel layer.
+ */
+
+/**
+ * @brief Sum of A(i, k) * A(j, k) over k < count
+ */
+template <typename T>
+static inline T rowProduct(const BasicMatrixView<const T> &A, int i, int j, int count)
+{
+    T sum = 0;
+    for (int k = 0; k < count; ++k)
+    {
+        sum += A(i, k) * A(j, k);
+    }
+    return sum;
+}
+
+/**
+ * @brief Sum of A(i, k) * B(k, c) over start <= k < end
+ */
+template <typename T>
+static inline T columnProduct(const BasicMatrixView<const T> &A, int i, const BasicMatrixView<const T> &B, int c, int start, int end)
+{
+    T sum = 0;
+    for (int k = start; k < end; ++k)
+    {
+        sum += A(i, k) * B(k, c);
+    }
+    return sum;
+}
+
+/**
+ * @brief Cholesky factorization in place.
+ *
+ * On success the lower triangle holds L and the strict upper triangle is zeroed.
+ *
+ * @param A Symmetric matrix (n x n); only the lower triangle is read
+ * @return true on success, false if A is not positive definite
+ */
+template <typename T>
+bool choleskyInPlace(const BasicMatrixView<T> &A)
+{
+    int n = A.rows();
+    for (int j = 0; j < n; ++j)
+    {
+        T d = A(j, j) - rowProduct<T>(A, j, j, j);
+        if (!(d > 0))
+        {
+            return false;
+        }
+        T ljj = sqrt(d);
+        A(j, j) = ljj;
+
+        for (int i = j + 1; i < n; ++i)
+        {
+            A(i, j) = (A(i, j) - rowProduct<T>(A, i, j, j)) / ljj;
+            A(j, i) = 0;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Solve L * L^T * X = B in place.
+ *
+ * @param L Cholesky factor from choleskyInPlace (n x n)
+ * @param B Right-hand sides (n x m), overwritten by X
+ */
+template <typename T>
+void choleskySolveInPlace(const BasicMatrixView<const T> &L, const BasicMatrixView<T> &B)
+{
+    int n = L.rows();
+
+    // Rows are the outer loop so each diagonal element is inverted only once
+    // Forward substitution L * Y = B
+    for (int i = 0; i < n; ++i)
+    {
+        T invDiagonal = T(1) / L(i, i);
+        for (int c = 0; c < B.cols(); ++c)
+        {
+            B(i, c) = (B(i, c) - columnProduct<T>(L, i, B, c, 0, i)) * invDiagonal;
+        }
+    }
+
+    // Back substitution L^T * X = Y
+    for (int i = n - 1; i >= 0; --i)
+    {
+        T invDiagonal = T(1) / L(i, i);
+        for (int c = 0; c < B.cols(); ++c)
+        {
+            T sum = B(i, c);
+            for (int k = i + 1; k < n; ++k)
+            {
+                sum -= L(k, i) * B(k, c);
+            }
+            B(i, c) = sum * invDiagonal;
+        }
+    }
+}
+
+/**
+ * @brief LDL^T factorization in place.
+ *
+ * On success the strict lower triangle holds the unit lower factor L, the
+ * diagonal holds D and the strict upper triangle is zeroed.
+ *
+ * @param A Symmetric matrix (n x n); only the lower triangle is read
+ * @return true on success, false if a zero pivot is encountered
+ */
+template <typename T>
+bool ldltInPlace(const BasicMatrixView<T> &A)
+{
+    int n = A.rows();
+    for (int j = 0; j < n; ++j)
+    {
+        // Scratch: A(j, k) * D(k) for k < j, stored temporarily in the upper triangle
+        for (int k = 0; k < j; ++k)
+        {
+            A(k, j) = A(j, k) * A(k, k);
+        }
+
+        T d = A(j, j);
+        for (int k = 0; k < j; ++k)
+        {
+            d -= A(j, k) * A(k, j);
+        }
+        if (d == 0)
+        {
+            return false;
+        }
+        A(j, j) = d;
+
+        for (int i = j + 1; i < n; ++i)
+        {
+            T sum = A(i, j);
+            for (int k = 0; k < j; ++k)
+            {
+                sum -= A(i, k) * A(k, j);
+            }
+            A(i, j) = sum / d;
+        }
+
+        for (int k = 0; k < j; ++k)
+        {
+            A(k, j) = 0;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Solve L * D * L^T * X = B in place.
+ *
+ * @param LD Factor from ldltInPlace (n x n)
+ * @param B Right-hand sides (n x m), overwritten by X
+ */
+template <typename T>
+void ldltSolveInPlace(const BasicMatrixView<const T> &LD, const BasicMatrixView<T> &B)
+{
+    int n = LD.rows();
+
+    // L * Y = B (unit diagonal)
+    for (int i = 0; i < n; ++i)
+    {
+        for (int c = 0; c < B.cols(); ++c)
+        {
+            B(i, c) -= columnProduct<T>(LD, i, B, c, 0, i);
+        }
+    }
+
+    // D * Z = Y
+    for (int i = 0; i < n; ++i)
+    {
+        T invDiagonal = T(1) / LD(i, i);
+        for (int c = 0; c < B.cols(); ++c)
+        {
+            B(i, c) *= invDiagonal;
+        }
+    }
+
+    // L^T * X = Z
+    for (int i = n - 1; i >= 0; --i)
+    {
+        for (int c = 0; c < B.cols(); ++c)
+        {
+            T sum = B(i, c);
+            for (int k = i + 1; k < n; ++k)
+            {
+                sum -= LD(k, i) * B(k, c);
+            }
+            B(i, c) = sum;
+        }
+    }
+}
+
+/**
+ * @brief LU factorization with partial pivoting in place.
+ *
+ * On success the strict lower triangle holds the unit lower factor L and the
+ * upper triangle holds U. Row i was swapped with row pivots[i] at step i.
+ *
+ * @param A Square matrix (n x n)
+ * @param pivots Output array of n row indices
+ * @return true on success, false if A is singular
+ */
+template <typename T>
+bool luInPlace(const BasicMatrixView<T> &A, int *pivots)
+{
+    int n = A.rows();
+    for (int j = 0; j < n; ++j)
+    {
+        // Find the pivot row
+        int pivot = j;
+        for (int i = j + 1; i < n; ++i)
+        {
+            if (fabs(A(i, j)) > fabs(A(pivot, j)))
+                pivot = i;
+        }
+        pivots[j] = pivot;
+        if (A(pivot, j) == 0)
+        {
+            return false;
+        }
+        if (pivot != j)
+        {
+            for (int k = 0; k < n; ++k)
+            {
+                std::swap(A(j, k), A(pivot, k));
+            }
+        }
+
+        // Eliminate below the pivot
+        T invPivot = T(1) / A(j, j);
+        for (int i = j + 1; i < n; ++i)
+        {
+            T factor = A(i, j) * invPivot;
+            A(i, j) = factor;
+            for (int k = j + 1; k < n; ++k)
+            {
+                A(i, k) -= factor * A(j, k);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Solve A * X = B in place from a partial-pivot LU factorization.
+ *
+ * @param LU Factor from luInPlace (n x n)
+ * @param pivots Row pivots from luInPlace
+ * @param B Right-hand sides (n x m), overwritten by X
+ */
+template <typename T>
+void luSolveInPlace(const BasicMatrixView<const T> &LU, const int *pivots, const BasicMatrixView<T> &B)
+{
+    int n = LU.rows();
+
+    // Apply the row permutation
+    for (int i = 0; i < n; ++i)
+    {
+        if (pivots[i] != i)
+        {
+            for (int c = 0; c < B.cols(); ++c)
+            {
+                std::swap(B(i, c), B(pivots[i], c));
+            }
+        }
+    }
+
+    // L * Y = P * B (unit diagonal)
+    for (int i = 0; i < n; ++i)
+    {
+        for (int c = 0; c < B.cols(); ++c)
+        {
+            B(i, c) -= columnProduct<T>(LU, i, B, c, 0, i);
+        }
+    }
+    solveUpperTriangularInPlace<T>(LU, B);
+}
+
+/**
+ * @brief Solve R * X = B in place by back substitution.
+ *
+ * @param R Upper triangular matrix (n x n); the strict lower triangle is ignored
+ * @param B Right-hand sides (n x m), overwritten by X
+ * @return true on success, false if R has a zero on its diagonal
+ */
+template <typename T>
+bool solveUpperTriangularInPlace(const BasicMatrixView<const T> &R, const BasicMatrixView<T> &B)
+{
+    int n = R.rows();
+    for (int i = n - 1; i >= 0; --i)
+    {
+        if (R(i, i) == 0)
+        {
+            return false;
+        }
+        T invDiagonal = T(1) / R(i, i);
+        for (int c = 0; c < B.cols(); ++c)
+        {
+            B(i, c) = (B(i, c) - columnProduct<T>(R, i, B, c, i + 1, n)) * invDiagonal;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Solve min ||A * x - b|| with Householder QR applied in place to [A | b].
+ *
+ * Each reflection is applied to the remaining columns of A and to b as it is
+ * formed, so neither Q nor Q^T * b is ever built; the result is R in the upper
+ * triangle of A, Q^T * b in the last column and x from one back substitution.
+ * Householder QR stays accurate where Gram-Schmidt loses orthogonality, e.g.
+ * for nearly collinear anchors.
+ *
+ * @param Ab Augmented matrix [A | b] (m x (n + 1), m >= n), overwritten
+ * @param x Destination for the solution (n x 1)
+ * @param info Optional diagnostics (residual norm, rank, condition estimate)
+ * @param rankTolerance Diagonal entries of R below rankTolerance * max |R_ii| count as zero
+ * @return true on success, false if A is rank deficient
+ */
+bool householderLeastSquaresInPlace(const MatrixView &Ab, const MatrixView &x, LeastSquaresInfo *info, float rankTolerance)
+{
+    int m = Ab.rows();
+    int n = Ab.cols() - 1;
+
+    for (int j = 0; j < n; ++j)
+    {
+        // Reflect column j below the diagonal onto e_j
+        ColumnView column = Ab.block(j, j, m - j, 1).column(0);
+        float norm = column.norm();
+        if (norm == 0)
+        {
+            continue; // Nothing to eliminate, R_jj stays zero
+        }
+
+        float alpha = column[0] > 0 ? -norm : norm;
+        float v0 = column[0] - alpha;
+
+        // v = [v0, A(j + 1 .. m - 1, j)], ||v||^2 = norm^2 - a_jj^2 + v0^2
+        float vNorm2 = norm * norm - column[0] * column[0] + v0 * v0;
+        if (vNorm2 == 0)
+        {
+            continue; // Column is already a multiple of e_j
+        }
+
+        ConstColumnView tail = Ab.block(j + 1, j, m - j - 1, 1).column(0);
+        for (int c = j + 1; c <= n; ++c)
+        {
+            ColumnView target = Ab.block(j, c, m - j, 1).column(0);
+            ColumnView targetTail = Ab.block(j + 1, c, m - j - 1, 1).column(0);
+            float factor = 2.0f * (v0 * target[0] + tail.dot(targetTail)) / vNorm2;
+            target[0] -= factor * v0;
+            kernelAxpy(-factor, tail.data(), tail.stride(), targetTail.data(), targetTail.stride(), tail.size());
+        }
+        column[0] = alpha;
+    }
+
+    // Rank and condition from the diagonal of R
+    float maxDiagonal = 0;
+    float minDiagonal = 0;
+    for (int j = 0; j < n; ++j)
+    {
+        float d = fabs(Ab(j, j));
+        maxDiagonal = std::max(maxDiagonal, d);
+        minDiagonal = j == 0 ? d : std::min(minDiagonal, d);
+    }
+    int rank = 0;
+    for (int j = 0; j < n; ++j)
+    {
+        if (fabs(Ab(j, j)) > rankTolerance * maxDiagonal)
+            rank++;
+    }
+
+    if (info)
+    {
+        info->residualNorm = Ab.block(n, n, m - n, 1).column(0).norm();
+        info->rank = rank;
+        info->conditionEstimate = minDiagonal > 0 ? maxDiagonal / minDiagonal : INFINITY;
+    }
+
+    if (rank < n)
+    {
+        return false;
+    }
+
+    copy(Ab.block(0, n, n, 1), x);
+    return solveUpperTriangularInPlace<float>(Ab.block(0, 0, n, n), x);
+}
+
+#define INSTANTIATE_FACTORIZATIONS(T) \
+    template bool choleskyInPlace<T>(const BasicMatrixView<T> &); \
+    template void choleskySolveInPlace<T>(const BasicMatrixView<const T> &, const BasicMatrixView<T> &); \
+    template bool ldltInPlace<T>(const BasicMatrixView<T> &); \
+    template void ldltSolveInPlace<T>(const BasicMatrixView<const T> &, const BasicMatrixView<T> &); \
+    template bool luInPlace<T>(const BasicMatrixView<T> &, int *); \
+    template void luSolveInPlace<T>(const BasicMatrixView<const T> &, const int *, const BasicMatrixView<T> &); \
+    template bool solveUpperTriangularInPlace<T>(const BasicMatrixView<const T> &, const BasicMatrixView<T> &);
+
+INSTANTIATE_FACTORIZATIONS(float)
+INSTANTIATE_FACTORIZATIONS(double)
+INSTANTIATE_FACTORIZATIONS(Q16_16)
+INSTANTIATE_FACTORIZATIONS(Q8_24)
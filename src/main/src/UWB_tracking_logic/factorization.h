@@ -0,0 +1,186 @@
+#ifndef FACTORIZATION_H
+#define FACTORIZATION_H
+
+#include "matrix.h"
+#include "fixedMatrix.h"
+
+/**
+ * @brief Diagnostics of a least-squares solve.
+ */
+struct LeastSquaresInfo
+{
+    float residualNorm;      // ||A * x - b||
+    int rank;                // Numerical rank of A (number of significant diagonal entries of R)
+    float conditionEstimate; // max |R_ii| / min |R_ii|, a cheap estimate of cond(A)
+};
+
+// In-place factorizations and solves on views. B holds one right-hand side per column.
+// Templated on the scalar type and instantiated for float, double, Q16_16 and Q8_24;
+// pass T explicitly, since a mutable view does not deduce against a const one.
+template <typename T>
+bool choleskyInPlace(const BasicMatrixView<T> &A);
+template <typename T>
+void choleskySolveInPlace(const BasicMatrixView<const T> &L, const BasicMatrixView<T> &B);
+template <typename T>
+bool ldltInPlace(const BasicMatrixView<T> &A);
+template <typename T>
+void ldltSolveInPlace(const BasicMatrixView<const T> &LD, const BasicMatrixView<T> &B);
+template <typename T>
+bool luInPlace(const BasicMatrixView<T> &A, int *pivots);
+template <typename T>
+void luSolveInPlace(const BasicMatrixView<const T> &LU, const int *pivots, const BasicMatrixView<T> &B);
+template <typename T>
+bool solveUpperTriangularInPlace(const BasicMatrixView<const T> &R, const BasicMatrixView<T> &B);
+bool householderLeastSquaresInPlace(const MatrixView &Ab, const MatrixView &x, LeastSquaresInfo *info = nullptr,
+                                    float rankTolerance = 1e-5f);
+
+/**
+ * @brief Cholesky factorization A = L * L^T of a symmetric positive definite matrix.
+ *
+ * @tparam MatrixType Matrix or FixedMatrix<N, N, T>
+ */
+template <typename MatrixType>
+class Cholesky
+{
+public:
+    typedef typename MatrixType::Scalar Scalar;
+
+    Cholesky() : ok(false) {}
+    explicit Cholesky(const MatrixType &A) { compute(A); }
+
+    bool compute(const MatrixType &A)
+    {
+        L = A;
+        ok = choleskyInPlace<Scalar>(L.view());
+        return ok;
+    }
+
+    bool success() const { return ok; }
+    const MatrixType &matrixL() const { return L; }
+
+    void solveInPlace(const BasicMatrixView<Scalar> &B) const { choleskySolveInPlace<Scalar>(L.view(), B); }
+
+    template <typename RhsType>
+    RhsType solve(const RhsType &B) const
+    {
+        RhsType X = B;
+        solveInPlace(X.view());
+        return X;
+    }
+
+private:
+    MatrixType L;
+    bool ok;
+};
+
+/**
+ * @brief Square-root free Cholesky factorization A = L * D * L^T.
+ *
+ * Works for symmetric matrices that are positive definite or indefinite but
+ * nonsingular. L has a unit diagonal; D is stored on the diagonal.
+ *
+ * @tparam MatrixType Matrix or FixedMatrix<N, N, T>
+ */
+template <typename MatrixType>
+class LDLT
+{
+public:
+    typedef typename MatrixType::Scalar Scalar;
+
+    LDLT() : ok(false) {}
+    explicit LDLT(const MatrixType &A) { compute(A); }
+
+    bool compute(const MatrixType &A)
+    {
+        LD = A;
+        ok = ldltInPlace<Scalar>(LD.view());
+        return ok;
+    }
+
+    bool success() const { return ok; }
+    const MatrixType &matrixLD() const { return LD; }
+
+    void solveInPlace(const BasicMatrixView<Scalar> &B) const { ldltSolveInPlace<Scalar>(LD.view(), B); }
+
+    template <typename RhsType>
+    RhsType solve(const RhsType &B) const
+    {
+        RhsType X = B;
+        solveInPlace(X.view());
+        return X;
+    }
+
+private:
+    MatrixType LD;
+    bool ok;
+};
+
+/**
+ * @brief Row permutation of PartialPivLU, in the arena for a Matrix.
+ */
+template <typename MatrixType>
+struct PivotStorage
+{
+    ArenaVector<int> pivots;
+
+    int *resize(int rows)
+    {
+        pivots.resize(rows);
+        return pivots.data();
+    }
+    const int *data() const { return pivots.data(); }
+};
+
+/**
+ * @brief Row permutation of PartialPivLU, inline for a FixedMatrix so it never allocates.
+ */
+template <int R, int C, typename T>
+struct PivotStorage<FixedMatrix<R, C, T>>
+{
+    int pivots[R];
+
+    int *resize(int) { return pivots; }
+    const int *data() const { return pivots; }
+};
+
+/**
+ * @brief LU factorization with partial (row) pivoting, P * A = L * U.
+ *
+ * @tparam MatrixType Matrix or FixedMatrix<N, N, T>
+ */
+template <typename MatrixType>
+class PartialPivLU
+{
+public:
+    typedef typename MatrixType::Scalar Scalar;
+
+    PartialPivLU() : ok(false) {}
+    explicit PartialPivLU(const MatrixType &A) { compute(A); }
+
+    bool compute(const MatrixType &A)
+    {
+        LU = A;
+        ok = luInPlace<Scalar>(LU.view(), pivots.resize(A.rows()));
+        return ok;
+    }
+
+    bool success() const { return ok; }
+    const MatrixType &matrixLU() const { return LU; }
+
+    void solveInPlace(const BasicMatrixView<Scalar> &B) const { luSolveInPlace<Scalar>(LU.view(), pivots.data(), B); }
+
+    template <typename RhsType>
+    RhsType solve(const RhsType &B) const
+    {
+        RhsType X = B;
+        solveInPlace(X.view());
+        return X;
+    }
+
+private:
+    MatrixType LU;
+    PivotStorage<MatrixType> pivots;
+    bool ok;
+};
+
+#endif // FACTORIZATION_H
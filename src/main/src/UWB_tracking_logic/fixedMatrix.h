@@ -0,0 +1,211 @@
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+#include "matrix.h"
+#include "matrixExpression.h"
+#include "fixedPoint.h"
+
+/**
+ * @brief Matrix with compile-time dimensions stored inline (no heap).
+ *
+ * All loop bounds are template constants, so the small products used by the
+ * Kalman filter are fully unrolled and dimension mismatches are compile errors
+ * instead of runtime checks. Arithmetic operators build lazy expressions (see
+ * matrixExpression.h) that are evaluated when assigned to a FixedMatrix.
+ *
+ * @tparam T Element type: float, double or a FixedPoint type
+ */
+template <int R, int C, typename T = float>
+class FixedMatrix : public MatrixExpression<FixedMatrix<R, C, T>>
+{
+public:
+    typedef T Scalar;
+    static const int Rows = R;
+    static const int Cols = C;
+
+    T values[R * C];
+
+    FixedMatrix() : values{} {}
+
+    /**
+     * @brief Evaluate an expression straight into the new matrix
+     */
+    template <typename E>
+    FixedMatrix(const MatrixExpression<E> &expr)
+    {
+        evaluate(expr.derived(), values);
+    }
+
+    /**
+     * @brief Assign an expression
+     *
+     * The expression may reference this matrix (P = F * P * F^T + Q), so it is
+     * evaluated into a stack temporary first.
+     */
+    template <typename E>
+    FixedMatrix &operator=(const MatrixExpression<E> &expr)
+    {
+        T result[R * C];
+        evaluate(expr.derived(), result);
+        std::copy(result, result + R * C, values);
+        return *this;
+    }
+
+    static constexpr int rows() { return R; }
+    static constexpr int cols() { return C; }
+
+    T &operator()(int row, int col) { return values[row * C + col]; }
+    T operator()(int row, int col) const { return values[row * C + col]; }
+    T coeff(int row, int col) const { return values[row * C + col]; }
+    void evalRow(int row, T *out) const { std::copy(values + row * C, values + (row + 1) * C, out); }
+    T *operator[](int row) { return values + row * C; }
+    const T *operator[](int row) const { return values + row * C; }
+
+    BasicMatrixView<T> view() { return BasicMatrixView<T>(values, R, C, C); }
+    BasicMatrixView<const T> view() const { return BasicMatrixView<const T>(values, R, C, C); }
+    operator BasicMatrixView<T>() { return view(); }
+    operator BasicMatrixView<const T>() const { return view(); }
+
+    /**
+     * @brief Set all elements to a value
+     */
+    void set_value(T val)
+    {
+#pragma GCC unroll 36
+        for (int i = 0; i < R * C; ++i)
+        {
+            values[i] = val;
+        }
+    }
+
+    /**
+     * @brief Set the matrix to a (scaled) identity
+     */
+    void set_identity(T scale = 1)
+    {
+        set_value(0);
+#pragma GCC unroll 6
+        for (int i = 0; i < (R < C ? R : C); ++i)
+        {
+            values[i * C + i] = scale;
+        }
+    }
+
+    static FixedMatrix identity(T scale = 1)
+    {
+        FixedMatrix result;
+        result.set_identity(scale);
+        return result;
+    }
+
+    /**
+     * @brief Inverse of a square matrix
+     *
+     * Closed-form adjugate for 1x1, 2x2 and 3x3; Gauss-Jordan with partial
+     * pivoting for larger sizes.
+     *
+     * @return FixedMatrix The inverse, or a zero matrix if singular
+     */
+    FixedMatrix inverse() const
+    {
+        static_assert(R == C, "inverse() requires a square matrix");
+        FixedMatrix result;
+        const T *m = values;
+        T *out = result.values;
+
+        if (R == 1)
+        {
+            if (m[0] != 0)
+                out[0] = T(1) / m[0];
+            return result;
+        }
+        if (R == 2)
+        {
+            T det = m[0] * m[3] - m[1] * m[2];
+            if (det == 0)
+                return result;
+            T invDet = T(1) / det;
+            out[0] = m[3] * invDet;
+            out[1] = -m[1] * invDet;
+            out[2] = -m[2] * invDet;
+            out[3] = m[0] * invDet;
+            return result;
+        }
+        if (R == 3)
+        {
+            T c00 = m[4] * m[8] - m[5] * m[7];
+            T c01 = m[5] * m[6] - m[3] * m[8];
+            T c02 = m[3] * m[7] - m[4] * m[6];
+            T det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+            if (det == 0)
+                return result;
+            T invDet = T(1) / det;
+            out[0] = c00 * invDet;
+            out[1] = (m[2] * m[7] - m[1] * m[8]) * invDet;
+            out[2] = (m[1] * m[5] - m[2] * m[4]) * invDet;
+            out[3] = c01 * invDet;
+            out[4] = (m[0] * m[8] - m[2] * m[6]) * invDet;
+            out[5] = (m[2] * m[3] - m[0] * m[5]) * invDet;
+            out[6] = c02 * invDet;
+            out[7] = (m[1] * m[6] - m[0] * m[7]) * invDet;
+            out[8] = (m[0] * m[4] - m[1] * m[3]) * invDet;
+            return result;
+        }
+
+        // Gauss-Jordan with partial pivoting on a copy
+        FixedMatrix a = *this;
+        result.set_identity();
+        for (int i = 0; i < R; ++i)
+        {
+            int pivot = i;
+            for (int k = i + 1; k < R; ++k)
+            {
+                if (fabs(a.values[k * C + i]) > fabs(a.values[pivot * C + i]))
+                    pivot = k;
+            }
+            if (a.values[pivot * C + i] == 0)
+                return FixedMatrix();
+            if (pivot != i)
+            {
+                for (int j = 0; j < C; ++j)
+                {
+                    std::swap(a.values[i * C + j], a.values[pivot * C + j]);
+                    std::swap(result.values[i * C + j], result.values[pivot * C + j]);
+                }
+            }
+
+            T invPivot = T(1) / a.values[i * C + i];
+            for (int j = 0; j < C; ++j)
+            {
+                a.values[i * C + j] *= invPivot;
+                result.values[i * C + j] *= invPivot;
+            }
+            for (int k = 0; k < R; ++k)
+            {
+                if (k == i)
+                    continue;
+                T factor = a.values[k * C + i];
+                for (int j = 0; j < C; ++j)
+                {
+                    a.values[k * C + j] -= factor * a.values[i * C + j];
+                    result.values[k * C + j] -= factor * result.values[i * C + j];
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    template <typename E>
+    static void evaluate(const E &expr, T *out)
+    {
+        static_assert(E::Rows == R && E::Cols == C, "Expression and destination have different dimensions");
+#pragma GCC unroll 6
+        for (int i = 0; i < R; ++i)
+        {
+            expr.evalRow(i, out + i * C);
+        }
+    }
+};
+
+#endif // FIXED_MATRIX_H
@@ -0,0 +1,152 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Saturating signed fixed-point number in Q(31 - FracBits).FracBits format.
+ *
+ * Stored in an int32_t; products and quotients go through int64_t and every
+ * result is clamped to the representable range instead of wrapping. Only
+ * integer instructions are used, so the tracking math can run inside an ISR or
+ * next to the DSP without saving FPU context.
+ *
+ * Conversions from int, float and double are implicit so literals mix freely
+ * with fixed-point values; conversions back are explicit.
+ *
+ * @tparam FracBits Number of fractional bits (16 for Q16.16, 24 for Q8.24)
+ */
+template <int FracBits>
+class FixedPoint
+{
+public:
+    static_assert(FracBits > 0 && FracBits < 31, "FixedPoint needs between 1 and 30 fractional bits");
+
+    static const int32_t MaxRaw = INT32_MAX;
+    static const int32_t MinRaw = -INT32_MAX; // Symmetric so negation never overflows
+
+    FixedPoint() : raw(0) {}
+    FixedPoint(int value) : raw(saturate((int64_t)value * ((int64_t)1 << FracBits))) {}
+    FixedPoint(float value) : raw(fromReal(value)) {}
+    FixedPoint(double value) : raw(fromReal(value)) {}
+
+    static FixedPoint fromRaw(int32_t value)
+    {
+        FixedPoint result;
+        result.raw = value;
+        return result;
+    }
+
+    int32_t rawValue() const { return raw; }
+    float toFloat() const { return (float)raw * (1.0f / (float)((int64_t)1 << FracBits)); }
+    double toDouble() const { return (double)raw / (double)((int64_t)1 << FracBits); }
+    explicit operator float() const { return toFloat(); }
+    explicit operator double() const { return toDouble(); }
+
+    /**
+     * @brief Smallest positive step
+     */
+    static FixedPoint epsilon() { return fromRaw(1); }
+
+    FixedPoint operator-() const { return fromRaw(-raw); }
+
+    friend FixedPoint operator+(FixedPoint a, FixedPoint b) { return fromRaw(saturate((int64_t)a.raw + b.raw)); }
+    friend FixedPoint operator-(FixedPoint a, FixedPoint b) { return fromRaw(saturate((int64_t)a.raw - b.raw)); }
+
+    /**
+     * @brief Product rounded to nearest
+     */
+    friend FixedPoint operator*(FixedPoint a, FixedPoint b)
+    {
+        int64_t product = (int64_t)a.raw * b.raw;
+        return fromRaw(saturate((product + ((int64_t)1 << (FracBits - 1))) >> FracBits));
+    }
+
+    /**
+     * @brief Quotient truncated toward zero; division by zero saturates
+     */
+    friend FixedPoint operator/(FixedPoint a, FixedPoint b)
+    {
+        if (b.raw == 0)
+        {
+            return fromRaw(a.raw >= 0 ? MaxRaw : MinRaw);
+        }
+        return fromRaw(saturate(((int64_t)a.raw * ((int64_t)1 << FracBits)) / b.raw));
+    }
+
+    FixedPoint &operator+=(FixedPoint other) { return *this = *this + other; }
+    FixedPoint &operator-=(FixedPoint other) { return *this = *this - other; }
+    FixedPoint &operator*=(FixedPoint other) { return *this = *this * other; }
+    FixedPoint &operator/=(FixedPoint other) { return *this = *this / other; }
+
+    friend bool operator==(FixedPoint a, FixedPoint b) { return a.raw == b.raw; }
+    friend bool operator!=(FixedPoint a, FixedPoint b) { return a.raw != b.raw; }
+    friend bool operator<(FixedPoint a, FixedPoint b) { return a.raw < b.raw; }
+    friend bool operator>(FixedPoint a, FixedPoint b) { return a.raw > b.raw; }
+    friend bool operator<=(FixedPoint a, FixedPoint b) { return a.raw <= b.raw; }
+    friend bool operator>=(FixedPoint a, FixedPoint b) { return a.raw >= b.raw; }
+
+    friend FixedPoint fabs(FixedPoint a) { return a.raw < 0 ? -a : a; }
+
+    /**
+     * @brief Square root by the bit-by-bit integer method (shifts and adds
+     * only); negative inputs return 0
+     */
+    friend FixedPoint sqrt(FixedPoint a)
+    {
+        if (a.raw <= 0)
+        {
+            return FixedPoint();
+        }
+        // sqrt(raw * 2^F) is the raw value of sqrt(a)
+        uint64_t value = (uint64_t)a.raw << FracBits;
+        uint64_t result = 0;
+        uint64_t bit = (uint64_t)1 << 62;
+        while (bit > value)
+        {
+            bit >>= 2;
+        }
+        while (bit != 0)
+        {
+            if (value >= result + bit)
+            {
+                value -= result + bit;
+                result = (result >> 1) + bit;
+            }
+            else
+            {
+                result >>= 1;
+            }
+            bit >>= 2;
+        }
+        return fromRaw((int32_t)result);
+    }
+
+private:
+    int32_t raw;
+
+    static int32_t saturate(int64_t value)
+    {
+        if (value > MaxRaw)
+            return MaxRaw;
+        if (value < MinRaw)
+            return MinRaw;
+        return (int32_t)value;
+    }
+
+    template <typename Real>
+    static int32_t fromReal(Real value)
+    {
+        Real scaled = value * (Real)((int64_t)1 << FracBits);
+        if (!(scaled < (Real)MaxRaw))
+            return scaled != scaled ? 0 : MaxRaw; // NaN maps to 0
+        if (!(scaled > (Real)MinRaw))
+            return MinRaw;
+        return (int32_t)(scaled + (scaled >= 0 ? (Real)0.5 : (Real)-0.5));
+    }
+};
+
+typedef FixedPoint<16> Q16_16; // Range +-32768, resolution 1.5e-5
+typedef FixedPoint<24> Q8_24;  // Range +-128, resolution 6e-8
+
+#endif // FIXED_POINT_H
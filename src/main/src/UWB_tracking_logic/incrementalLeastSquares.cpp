@@ -0,0 +1,237 @@
+#include "incrementalLeastSquares.h"
+
+/**
+ * @brief Create an empty system; the first solve triggers a rebuild.
+ */
+template <int Dims>
+IncrementalLeastSquares<Dims>::IncrementalLeastSquares()
+    : origin{}, count(0), updatesSinceRebuild(LS_REBUILD_INTERVAL)
+{
+}
+
+/**
+ * @brief Build the equation row of an anchor relative to the current origin
+ */
+template <int Dims>
+void IncrementalLeastSquares<Dims>::makeRow(const AnchorEntry &anchor, Row &row) const
+{
+    const float p[3] = {anchor.x - origin[0], anchor.y - origin[1], Dims == 3 ? anchor.z - origin[Dims - 1] : 0};
+
+    row.id = anchor.id;
+    row.timestamp = anchor.timestamp;
+    row.b = anchor.averageRange * anchor.averageRange;
+    for (int j = 0; j < Dims; ++j)
+    {
+        row.a[j] = -2 * p[j];
+        row.b -= p[j] * p[j];
+    }
+    row.a[Dims] = 1;
+}
+
+/**
+ * @brief Add (sign = 1) or remove (sign = -1) a row from the normal equations
+ */
+template <int Dims>
+void IncrementalLeastSquares<Dims>::accumulate(const Row &row, float sign)
+{
+    for (int i = 0; i < Unknowns; ++i)
+    {
+        float ai = sign * row.a[i];
+        for (int j = 0; j <= i; ++j)
+        {
+            AtA(i, j) += ai * row.a[j];
+        }
+        Atb(i, 0) += ai * row.b;
+    }
+}
+
+/**
+ * @brief Downdate and drop the row at an index
+ */
+template <int Dims>
+void IncrementalLeastSquares<Dims>::removeAt(int index)
+{
+    accumulate(rows[index], -1);
+    rows[index] = rows[--count];
+    ++updatesSinceRebuild;
+}
+
+/**
+ * @brief Insert or replace the row of an anchor with its latest range.
+ *
+ * A replaced row is downdated first; when the table is full the oldest row
+ * makes room.
+ *
+ * @param anchor Registry entry holding the anchor coordinates and range
+ */
+template <int Dims>
+void IncrementalLeastSquares<Dims>::setRange(const AnchorEntry &anchor)
+{
+    int index = -1;
+    int oldest = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (rows[i].id == anchor.id)
+        {
+            index = i;
+            break;
+        }
+        if (rows[i].timestamp < rows[oldest].timestamp)
+        {
+            oldest = i;
+        }
+    }
+
+    if (index >= 0)
+    {
+        accumulate(rows[index], -1);
+    }
+    else
+    {
+        if (count == MAX_ANCHORS)
+        {
+            removeAt(oldest);
+        }
+        index = count++;
+    }
+
+    makeRow(anchor, rows[index]);
+    accumulate(rows[index], 1);
+    ++updatesSinceRebuild;
+}
+
+/**
+ * @brief Remove the row of an anchor
+ *
+ * @return true if the anchor had a row
+ */
+template <int Dims>
+bool IncrementalLeastSquares<Dims>::removeRange(uint16_t id)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (rows[i].id == id)
+        {
+            removeAt(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Downdate every row whose range the registry no longer holds.
+ *
+ * Covers expired ranges as well as anchors that were moved or removed.
+ *
+ * @param registry Anchors and their latest ranges
+ * @param now Current time in milliseconds
+ */
+template <int Dims>
+void IncrementalLeastSquares<Dims>::expire(const AnchorRegistry &registry, unsigned long now)
+{
+    for (int i = count - 1; i >= 0; --i)
+    {
+        const AnchorEntry *anchor = registry.findAnchor(rows[i].id);
+        if (!anchor || !registry.isFresh(*anchor, now) || anchor->timestamp != rows[i].timestamp)
+        {
+            removeAt(i);
+        }
+    }
+}
+
+/**
+ * @brief Recompute the normal equations from scratch.
+ *
+ * Takes every fresh anchor from the registry and moves the origin to their
+ * centroid. Clears the rounding that rank-1 updates and downdates accumulate.
+ *
+ * @param registry Anchors and their latest ranges
+ * @param now Current time in milliseconds
+ */
+template <int Dims>
+void IncrementalLeastSquares<Dims>::rebuild(const AnchorRegistry &registry, unsigned long now)
+{
+    float sum[3] = {0, 0, 0};
+    int fresh = 0;
+    for (int i = 0; i < registry.size(); ++i)
+    {
+        const AnchorEntry &anchor = registry.entry(i);
+        if (registry.isFresh(anchor, now))
+        {
+            sum[0] += anchor.x;
+            sum[1] += anchor.y;
+            sum[2] += anchor.z;
+            ++fresh;
+        }
+    }
+    for (int j = 0; j < Dims; ++j)
+    {
+        origin[j] = fresh > 0 ? sum[j] / fresh : 0;
+    }
+
+    AtA.set_value(0);
+    Atb.set_value(0);
+    count = 0;
+    for (int i = 0; i < registry.size() && count < MAX_ANCHORS; ++i)
+    {
+        const AnchorEntry &anchor = registry.entry(i);
+        if (registry.isFresh(anchor, now))
+        {
+            makeRow(anchor, rows[count]);
+            accumulate(rows[count], 1);
+            ++count;
+        }
+    }
+    updatesSinceRebuild = 0;
+}
+
+/**
+ * @brief Solve the normal equations for the position.
+ *
+ * @param position Output, Dims coordinates
+ * @param conditionEstimate Optional output, (max L_ii / min L_ii)^2 of the Cholesky factor
+ * @return TrackingStatus TRACKING_OK, TRACKING_NOT_ENOUGH_POINTS or TRACKING_RANK_DEFICIENT
+ */
+template <int Dims>
+TrackingStatus IncrementalLeastSquares<Dims>::solve(float *position, float *conditionEstimate) const
+{
+    if (count < Unknowns)
+    {
+        return TRACKING_NOT_ENOUGH_POINTS;
+    }
+
+    Cholesky<FixedMatrix<Unknowns, Unknowns>> cholesky(AtA);
+    if (!cholesky.success())
+    {
+        return TRACKING_RANK_DEFICIENT;
+    }
+
+    const FixedMatrix<Unknowns, Unknowns> &L = cholesky.matrixL();
+    float maxDiagonal = L(0, 0);
+    float minDiagonal = L(0, 0);
+    for (int i = 1; i < Unknowns; ++i)
+    {
+        maxDiagonal = std::max(maxDiagonal, L(i, i));
+        minDiagonal = std::min(minDiagonal, L(i, i));
+    }
+    float condition = (maxDiagonal / minDiagonal) * (maxDiagonal / minDiagonal);
+    if (conditionEstimate)
+    {
+        *conditionEstimate = condition;
+    }
+    if (!(condition < LS_MAX_CONDITION))
+    {
+        return TRACKING_RANK_DEFICIENT;
+    }
+
+    FixedMatrix<Unknowns, 1> x = cholesky.solve(Atb);
+    for (int j = 0; j < Dims; ++j)
+    {
+        position[j] = x(j, 0) + origin[j];
+    }
+    return TRACKING_OK;
+}
+
+template class IncrementalLeastSquares<2>;
+template class IncrementalLeastSquares<3>;
@@ -0,0 +1,76 @@
+#ifndef INCREMENTAL_LEAST_SQUARES_H
+#define INCREMENTAL_LEAST_SQUARES_H
+
+#include "fixedMatrix.h"
+#include "factorization.h"
+#include "anchorRegistry.h"
+#include "status.h"
+
+#ifndef LS_REBUILD_INTERVAL
+#define LS_REBUILD_INTERVAL 64 // Range updates between full rebuilds of the normal equations
+#endif
+
+#ifndef LS_MAX_CONDITION
+#define LS_MAX_CONDITION 1e5f // Above this estimate of cond(A^T A) the solve is rejected
+#endif
+
+/**
+ * @brief Range least squares kept as normal equations, updated one anchor at a time.
+ *
+ * Anchor i at p_i with range d_i gives the linear equation
+ *
+ *     -2 p_i . x + R = d_i^2 - |p_i|^2,    R = |x|^2
+ *
+ * in the unknowns [x, R]. Unlike differencing against a reference anchor,
+ * every row depends on a single anchor, so a new range is a rank-1 update of
+ * A^T A and A^T b and a replaced or expired one is a rank-1 downdate. A
+ * position costs one (Dims + 1) x (Dims + 1) Cholesky solve whatever the
+ * window size.
+ *
+ * Coordinates are taken relative to an origin fixed at the last rebuild, which
+ * keeps the sums well scaled; rebuild() recomputes them from the registry and
+ * is due every LS_REBUILD_INTERVAL updates to shed accumulated rounding.
+ *
+ * Needs at least Dims + 1 anchors that are not coplanar (3D) or collinear (2D);
+ * solve() reports TRACKING_RANK_DEFICIENT otherwise.
+ */
+template <int Dims>
+class IncrementalLeastSquares
+{
+public:
+    static const int Unknowns = Dims + 1;
+
+    IncrementalLeastSquares();
+
+    void setRange(const AnchorEntry &anchor);
+    bool removeRange(uint16_t id);
+    void expire(const AnchorRegistry &registry, unsigned long now);
+    void rebuild(const AnchorRegistry &registry, unsigned long now);
+
+    bool needsRebuild() const { return updatesSinceRebuild >= LS_REBUILD_INTERVAL; }
+    int size() const { return count; }
+
+    TrackingStatus solve(float *position, float *conditionEstimate = nullptr) const;
+
+private:
+    struct Row
+    {
+        uint16_t id;             // Anchor the row belongs to
+        unsigned long timestamp; // millis() of the range
+        float a[Unknowns];       // Coefficients [-2 p, 1]
+        float b;                 // d^2 - |p|^2
+    };
+
+    void makeRow(const AnchorEntry &anchor, Row &row) const;
+    void accumulate(const Row &row, float sign);
+    void removeAt(int index);
+
+    FixedMatrix<Unknowns, Unknowns> AtA; // Lower triangle of A^T A
+    FixedMatrix<Unknowns, 1> Atb;        // A^T b
+    float origin[Dims];                  // Coordinates are relative to this point
+    Row rows[MAX_ANCHORS];               // Rows currently in the sums
+    int count;
+    int updatesSinceRebuild;
+};
+
+#endif // INCREMENTAL_LEAST_SQUARES_H
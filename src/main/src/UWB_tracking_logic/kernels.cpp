@@ -0,0 +1,427 @@
+#include "kernels.h"
+#include <cfloat>
+
+#if defined(TRACKING_KERNELS_BACKEND_ESP_DSP)
+#include <esp_dsp.h>
+#elif defined(TRACKING_KERNELS_BACKEND_AVX)
+#include <immintrin.h>
+#elif defined(TRACKING_KERNELS_BACKEND_SSE)
+#include <xmmintrin.h>
+#endif
+
+/**
+ * @brief Scalar reference matrix product C = A * B
+ *
+ * @param A Left operand (m x k)
+ * @param B Right operand (k x n)
+ * @param C Result (m x n), must not alias A or B
+ */
+void scalarGemm(const float *A, const float *B, float *C, int m, int k, int n)
+{
+    for (int i = 0; i < m; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            float sum = 0;
+            for (int p = 0; p < k; ++p)
+            {
+                sum += A[i * k + p] * B[p * n + j];
+            }
+            C[i * n + j] = sum;
+        }
+    }
+}
+
+/**
+ * @brief Scalar reference matrix-vector product y = A * x
+ *
+ * @param A Matrix (m x n)
+ * @param x Vector (n)
+ * @param y Result (m)
+ */
+void scalarGemv(const float *A, const float *x, float *y, int m, int n)
+{
+    for (int i = 0; i < m; ++i)
+    {
+        y[i] = scalarDot(A + i * n, 1, x, 1, n);
+    }
+}
+
+/**
+ * @brief Scalar reference dot product of two strided vectors
+ */
+float scalarDot(const float *a, int strideA, const float *b, int strideB, int n)
+{
+    float sum = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        sum += a[i * strideA] * b[i * strideB];
+    }
+    return sum;
+}
+
+/**
+ * @brief Scalar reference y += alpha * x on strided vectors
+ */
+void scalarAxpy(float alpha, const float *x, int strideX, float *y, int strideY, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        y[i * strideY] += alpha * x[i * strideX];
+    }
+}
+
+/**
+ * @brief Scalar reference Euclidean norm
+ */
+float scalarNorm(const float *x, int n)
+{
+    return sqrt(scalarDot(x, 1, x, 1, n));
+}
+
+#if defined(TRACKING_KERNELS_BACKEND_AVX) || defined(TRACKING_KERNELS_BACKEND_SSE)
+
+#if defined(TRACKING_KERNELS_BACKEND_AVX)
+#define SIMD_WIDTH 8
+typedef __m256 simd_t;
+#define simd_load _mm256_loadu_ps
+#define simd_store _mm256_storeu_ps
+#define simd_set1 _mm256_set1_ps
+#define simd_zero _mm256_setzero_ps
+#define simd_add _mm256_add_ps
+#define simd_mul _mm256_mul_ps
+#else
+#define SIMD_WIDTH 4
+typedef __m128 simd_t;
+#define simd_load _mm_loadu_ps
+#define simd_store _mm_storeu_ps
+#define simd_set1 _mm_set1_ps
+#define simd_zero _mm_setzero_ps
+#define simd_add _mm_add_ps
+#define simd_mul _mm_mul_ps
+#endif
+
+/**
+ * @brief Horizontal sum of a SIMD register
+ */
+static float simdSum(simd_t v)
+{
+    float lanes[SIMD_WIDTH];
+    simd_store(lanes, v);
+    float sum = 0;
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        sum += lanes[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief SIMD dot product of two contiguous vectors
+ */
+static float simdDot(const float *a, const float *b, int n)
+{
+    simd_t acc = simd_zero();
+    int i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        acc = simd_add(acc, simd_mul(simd_load(a + i), simd_load(b + i)));
+    }
+    float sum = simdSum(acc);
+    for (; i < n; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief SIMD y += alpha * x on contiguous vectors
+ */
+static void simdAxpy(float alpha, const float *x, float *y, int n)
+{
+    simd_t a = simd_set1(alpha);
+    int i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_store(y + i, simd_add(simd_load(y + i), simd_mul(a, simd_load(x + i))));
+    }
+    for (; i < n; ++i)
+    {
+        y[i] += alpha * x[i];
+    }
+}
+
+/**
+ * @brief Matrix product C = A * B (A m x k, B k x n, C m x n)
+ */
+void kernelGemm(const float *A, const float *B, float *C, int m, int k, int n)
+{
+    // Row i of C accumulates A[i][p] * row p of B, vectorized along the row
+    for (int i = 0; i < m; ++i)
+    {
+        float *row = C + i * n;
+        for (int j = 0; j < n; ++j)
+        {
+            row[j] = 0;
+        }
+        for (int p = 0; p < k; ++p)
+        {
+            simdAxpy(A[i * k + p], B + p * n, row, n);
+        }
+    }
+}
+
+/**
+ * @brief Matrix-vector product y = A * x (A m x n)
+ */
+void kernelGemv(const float *A, const float *x, float *y, int m, int n)
+{
+    for (int i = 0; i < m; ++i)
+    {
+        y[i] = simdDot(A + i * n, x, n);
+    }
+}
+
+/**
+ * @brief Dot product of two contiguous vectors
+ */
+float kernelDot(const float *a, const float *b, int n)
+{
+    return simdDot(a, b, n);
+}
+
+/**
+ * @brief Dot product of two strided vectors (SIMD only when both are contiguous)
+ */
+float kernelDotStrided(const float *a, int strideA, const float *b, int strideB, int n)
+{
+    if (strideA == 1 && strideB == 1)
+        return simdDot(a, b, n);
+    return scalarDot(a, strideA, b, strideB, n);
+}
+
+/**
+ * @brief y += alpha * x (SIMD only when both are contiguous)
+ */
+void kernelAxpy(float alpha, const float *x, int strideX, float *y, int strideY, int n)
+{
+    if (strideX == 1 && strideY == 1)
+        simdAxpy(alpha, x, y, n);
+    else
+        scalarAxpy(alpha, x, strideX, y, strideY, n);
+}
+
+/**
+ * @brief Euclidean norm of a contiguous vector
+ */
+float kernelNorm(const float *x, int n)
+{
+    return sqrt(simdDot(x, x, n));
+}
+
+/**
+ * @brief Name of the compiled-in backend
+ */
+const char *kernelBackend()
+{
+#if defined(TRACKING_KERNELS_BACKEND_AVX)
+    return "AVX";
+#else
+    return "SSE";
+#endif
+}
+
+#elif defined(TRACKING_KERNELS_BACKEND_ESP_DSP)
+
+void kernelGemm(const float *A, const float *B, float *C, int m, int k, int n)
+{
+    dspm_mult_f32(A, B, C, m, k, n);
+}
+
+void kernelGemv(const float *A, const float *x, float *y, int m, int n)
+{
+    dspm_mult_f32(A, x, y, m, n, 1);
+}
+
+float kernelDot(const float *a, const float *b, int n)
+{
+    float result = 0;
+    dsps_dotprod_f32(a, b, &result, n);
+    return result;
+}
+
+float kernelDotStrided(const float *a, int strideA, const float *b, int strideB, int n)
+{
+    float result = 0;
+    dsps_dotprode_f32(a, b, &result, n, strideA, strideB);
+    return result;
+}
+
+void kernelAxpy(float alpha, const float *x, int strideX, float *y, int strideY, int n)
+{
+    // ESP-DSP has no fused axpy; the scalar loop is a single madd per element on the Xtensa FPU
+    scalarAxpy(alpha, x, strideX, y, strideY, n);
+}
+
+float kernelNorm(const float *x, int n)
+{
+    return sqrt(kernelDot(x, x, n));
+}
+
+const char *kernelBackend()
+{
+    return "ESP-DSP";
+}
+
+#else
+
+void kernelGemm(const float *A, const float *B, float *C, int m, int k, int n)
+{
+    scalarGemm(A, B, C, m, k, n);
+}
+
+void kernelGemv(const float *A, const float *x, float *y, int m, int n)
+{
+    scalarGemv(A, x, y, m, n);
+}
+
+float kernelDot(const float *a, const float *b, int n)
+{
+    return scalarDot(a, 1, b, 1, n);
+}
+
+float kernelDotStrided(const float *a, int strideA, const float *b, int strideB, int n)
+{
+    return scalarDot(a, strideA, b, strideB, n);
+}
+
+void kernelAxpy(float alpha, const float *x, int strideX, float *y, int strideY, int n)
+{
+    scalarAxpy(alpha, x, strideX, y, strideY, n);
+}
+
+float kernelNorm(const float *x, int n)
+{
+    return scalarNorm(x, n);
+}
+
+const char *kernelBackend()
+{
+    return "scalar";
+}
+
+#endif
+
+/**
+ * @brief Deterministic pseudo-random value in [-1, 1) for the self test
+ */
+static float selfTestValue(uint32_t &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return (float)(state >> 8) / (float)(1u << 23) - 1.0f;
+}
+
+/**
+ * @brief Check whether a backend result is within float rounding of the reference
+ *
+ * @param value Backend result
+ * @param reference Scalar reference result
+ * @param magnitude Sum of absolute values of the accumulated terms
+ * @param n Number of accumulated terms
+ */
+static bool withinTolerance(float value, float reference, float magnitude, int n)
+{
+    // Standard forward error bound of a length-n float summation
+    return fabs(value - reference) <= 2.0f * (n + 1) * FLT_EPSILON * magnitude + FLT_MIN;
+}
+
+/**
+ * @brief Compare the active backend against the scalar reference.
+ *
+ * Runs gemm, gemv, dot, axpy and norm on deterministic data of several sizes
+ * (including ones that are not a multiple of the SIMD width) and prints the
+ * first mismatch over Serial.
+ *
+ * @return true if every result is within the rounding tolerance
+ */
+bool kernelSelfTest()
+{
+    const int MAX_SIZE = 13;
+    float A[MAX_SIZE * MAX_SIZE], B[MAX_SIZE * MAX_SIZE], C[MAX_SIZE * MAX_SIZE], Cref[MAX_SIZE * MAX_SIZE];
+    float absA[MAX_SIZE * MAX_SIZE], absB[MAX_SIZE * MAX_SIZE], absC[MAX_SIZE * MAX_SIZE];
+    uint32_t state = 12345;
+
+    for (int m = 1; m <= MAX_SIZE; m += 3)
+    {
+        for (int k = 1; k <= MAX_SIZE; k += 2)
+        {
+            int n = MAX_SIZE - m + 1;
+            for (int i = 0; i < m * k; ++i)
+            {
+                A[i] = selfTestValue(state);
+                absA[i] = fabs(A[i]);
+            }
+            for (int i = 0; i < k * n; ++i)
+            {
+                B[i] = selfTestValue(state);
+                absB[i] = fabs(B[i]);
+            }
+
+            scalarGemm(absA, absB, absC, m, k, n);
+
+            scalarGemm(A, B, Cref, m, k, n);
+            kernelGemm(A, B, C, m, k, n);
+            for (int i = 0; i < m * n; ++i)
+            {
+                if (!withinTolerance(C[i], Cref[i], absC[i], k))
+                {
+                    Serial.printf("Kernel self test: gemm %dx%dx%d mismatch at %d (%g vs %g)\n", m, k, n, i, C[i], Cref[i]);
+                    return false;
+                }
+            }
+
+            scalarGemv(A, B, Cref, m, k);
+            kernelGemv(A, B, C, m, k);
+            scalarGemv(absA, absB, absC, m, k);
+            for (int i = 0; i < m; ++i)
+            {
+                if (!withinTolerance(C[i], Cref[i], absC[i], k))
+                {
+                    Serial.printf("Kernel self test: gemv %dx%d mismatch at %d (%g vs %g)\n", m, k, i, C[i], Cref[i]);
+                    return false;
+                }
+            }
+
+            int len = m * k;
+            float magnitude = scalarDot(absA, 1, absA, 1, len);
+            float dotRef = scalarDot(A, 1, B, 1, len);
+            if (!withinTolerance(kernelDot(A, B, len), dotRef, scalarDot(absA, 1, absB, 1, len), len) ||
+                !withinTolerance(kernelDotStrided(A, k, B, 1, m), scalarDot(A, k, B, 1, m), scalarDot(absA, k, absB, 1, m), m) ||
+                !withinTolerance(kernelNorm(A, len) * kernelNorm(A, len), magnitude, magnitude, len + 2))
+            {
+                Serial.printf("Kernel self test: dot/norm mismatch at length %d\n", len);
+                return false;
+            }
+
+            for (int i = 0; i < len; ++i)
+            {
+                C[i] = Cref[i] = B[i];
+            }
+            float alpha = selfTestValue(state);
+            scalarAxpy(alpha, A, 1, Cref, 1, len);
+            kernelAxpy(alpha, A, 1, C, 1, len);
+            for (int i = 0; i < len; ++i)
+            {
+                if (!withinTolerance(C[i], Cref[i], fabs(alpha * A[i]) + fabs(B[i]), 1))
+                {
+                    Serial.printf("Kernel self test: axpy mismatch at %d (%g vs %g)\n", i, C[i], Cref[i]);
+                    return false;
+                }
+            }
+        }
+    }
+
+    Serial.printf("Kernel self test passed (%s backend)\n", kernelBackend());
+    return true;
+}
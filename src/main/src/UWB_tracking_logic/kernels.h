@@ -0,0 +1,51 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <Arduino.h>
+
+/*
+ * Kernel backend for the dense matrix operations.
+ *
+ * The backend is selected at compile time:
+ *  - ESP-DSP (dspm_mult_f32, dsps_dotprod_f32) on the ESP32 when esp_dsp.h is available
+ *  - AVX or SSE on host builds
+ *  - the portable scalar reference otherwise, or when TRACKING_KERNELS_SCALAR is defined
+ *
+ * All matrices are row-major and contiguous unless a stride is given.
+ */
+
+#if defined(TRACKING_KERNELS_SCALAR)
+#define TRACKING_KERNELS_BACKEND_SCALAR
+#elif defined(ESP_PLATFORM) && defined(__has_include)
+#if __has_include(<esp_dsp.h>)
+#define TRACKING_KERNELS_BACKEND_ESP_DSP
+#else
+#define TRACKING_KERNELS_BACKEND_SCALAR
+#endif
+#elif defined(__AVX__)
+#define TRACKING_KERNELS_BACKEND_AVX
+#elif defined(__SSE__)
+#define TRACKING_KERNELS_BACKEND_SSE
+#else
+#define TRACKING_KERNELS_BACKEND_SCALAR
+#endif
+
+// Dispatched kernels
+void kernelGemm(const float *A, const float *B, float *C, int m, int k, int n);
+void kernelGemv(const float *A, const float *x, float *y, int m, int n);
+float kernelDot(const float *a, const float *b, int n);
+float kernelDotStrided(const float *a, int strideA, const float *b, int strideB, int n);
+void kernelAxpy(float alpha, const float *x, int strideX, float *y, int strideY, int n);
+float kernelNorm(const float *x, int n);
+const char *kernelBackend();
+
+// Portable scalar reference
+void scalarGemm(const float *A, const float *B, float *C, int m, int k, int n);
+void scalarGemv(const float *A, const float *x, float *y, int m, int n);
+float scalarDot(const float *a, int strideA, const float *b, int strideB, int n);
+void scalarAxpy(float alpha, const float *x, int strideX, float *y, int strideY, int n);
+float scalarNorm(const float *x, int n);
+
+bool kernelSelfTest();
+
+#endif // KERNELS_H
@@ -6,7 +6,7 @@
  * @param cords Matrix of coordinates (rows x cols)
  * @return Matrix The centroid of the coordinates
  */
-Matrix computeCentroid(const Matrix &cords)
+Matrix computeCentroid(const ConstMatrixView &cords)
 {
     int rows = cords.rows();
     int cols = cords.cols();
@@ -14,7 +14,7 @@ Matrix computeCentroid(const Matrix &cords)
     // Check if the matrix is empty
     if (rows == 0 || cols == 0)
     {
-        Serial.println("Error computeCentroid: Empty matrix.");
+        TRACKING_ERROR(TRACKING_EMPTY_INPUT, "Error computeCentroid: Empty matrix.");
         return Matrix(1, cols);
     }
 
@@ -25,7 +25,7 @@ Matrix computeCentroid(const Matrix &cords)
         float sum = 0;
         for (int i = 0; i < rows; ++i)
         {
-            sum += cords[i][j];
+            sum += cords(i, j);
         }
         centroid[0][j] = sum / rows;
     }
@@ -40,10 +40,10 @@ Matrix computeCentroid(const Matrix &cords)
  * @param distances Matrix of distances from the anchor points (rows x 1)
  * @return std::pair<Matrix, Matrix> (A, b) where A is the matrix of coefficients and b is the right-hand side vector
  */
-std::pair<Matrix, Matrix> computeEquations(const Matrix &cords, const Matrix &distances)
+std::pair<Matrix, Matrix> computeEquations(const ConstMatrixView &cords, const ConstColumnView &distances)
 {
-    int rows = cords.matrix.size();    // Number of anchor points
-    int cols = cords.matrix[0].size(); // Number of spatial dimensions (2 for XY, 3 for XYZ)
+    int rows = cords.rows(); // Number of anchor points
+    int cols = cords.cols(); // Number of spatial dimensions (2 for XY, 3 for XYZ)
 
     // Create matrix A (rows-1 x cols) for the system of equations
     Matrix A(rows - 1, cols);
@@ -51,7 +51,7 @@ std::pair<Matrix, Matrix> computeEquations(const Matrix &cords, const Matrix &di
     {
         for (int j = 0; j < cols; ++j)
         {
-            A[i - 1][j] = cords[i][j] - cords[0][j];
+            A[i - 1][j] = cords(i, j) - cords(0, j);
         }
     }
 
@@ -59,10 +59,10 @@ std::pair<Matrix, Matrix> computeEquations(const Matrix &cords, const Matrix &di
     Matrix b(rows - 1, 1);
     for (int i = 1; i < rows; ++i)
     {
-        b[i - 1][0] = distances[0][0] * distances[0][0] - distances[i][0] * distances[i][0];
+        b[i - 1][0] = distances[0] * distances[0] - distances[i] * distances[i];
         for (int j = 0; j < cols; j++)
         {
-            b[i - 1][0] += (cords[i][j] * cords[i][j]) - (cords[0][j] * cords[0][j]);
+            b[i - 1][0] += (cords(i, j) * cords(i, j)) - (cords(0, j) * cords(0, j));
         }
         b[i - 1][0] /= 2.0;
     }
@@ -71,105 +71,145 @@ std::pair<Matrix, Matrix> computeEquations(const Matrix &cords, const Matrix &di
 }
 
 /**
- * @brief Compute Singular Value Decomposition (SVD) using Jacobi method.
+ * @brief Compute Singular Value Decomposition (SVD) using the one-sided Jacobi method.
+ *
+ * Plane rotations are applied to pairs of columns of A until all columns are
+ * mutually orthogonal; the column norms are then the singular values and the
+ * accumulated rotations form V. A^T * A is never formed, so the small singular
+ * values that decide coplanarity keep full float accuracy.
  *
  * @param A Input matrix (m x n)
- * @return std::tuple<Matrix, Matrix, Matrix> (U, Sigma, V^T)
+ * @param uMode Which U to compute: none (empty matrix), thin (m x n) or full (m x m)
+ * @param maxSweeps Upper bound on the number of sweeps over all column pairs
+ * @return std::tuple<Matrix, Matrix, Matrix> (U, Sigma, V), singular values in descending order
  */
-std::tuple<Matrix, Matrix, Matrix> svd(const Matrix &A)
+std::tuple<Matrix, Matrix, Matrix> svd(const ConstMatrixView &A, SvdUMode uMode, int maxSweeps)
 {
     int m = A.rows();
     int n = A.cols();
+    const float tolerance = 1e-7f;
 
-    // 1. Compute A^T * A
-    Matrix At = A.transpose();
-    Matrix AtA = At * A; // Use your Matrix multiplication
-
-    // 2. Eigen-decomposition of A^T * A  (Using a power iteration-like method)
-    Matrix V(n, n);
-    Matrix Sigma(m, n); // Sigma is m x n
-    std::vector<float> singularValues(n);
-
-    // Initialize V to identity matrix
-    V.set_identity();
+    // Work on W = A^T so every column of A is a contiguous row
+    Matrix W(A.transpose());
+    Matrix Vt(n, n); // V^T, rotated alongside W
+    Vt.set_identity();
 
-    // Power iteration parameters
-    int numIterations = 100;
-    float tolerance = 1e-6f;
-
-    for (int i = 0; i < n; ++i)
+    for (int sweep = 0; sweep < maxSweeps; ++sweep)
     {
-        Matrix vk = V.getColumn(i); // Start with i-th column of V
-        for (int iter = 0; iter < numIterations; ++iter)
+        bool rotated = false;
+        for (int p = 0; p < n - 1; ++p)
         {
-            
-            Matrix vk1 = AtA * vk; // AtA * vk
-            float norm_vk1 = vk1.norm();
-            if (norm_vk1 < 1e-6)
+            for (int q = p + 1; q < n; ++q)
             {
-                // handle the zero vector.
-                break;
+                float *wp = W[p];
+                float *wq = W[q];
+                float alpha = kernelDot(wp, wp, m);
+                float beta = kernelDot(wq, wq, m);
+                float gamma = kernelDot(wp, wq, m);
+
+                if (fabs(gamma) <= tolerance * sqrt(alpha * beta) || gamma == 0)
+                    continue;
+                rotated = true;
+
+                // Rotation that zeroes the (p, q) entry of W * W^T
+                float zeta = (beta - alpha) / (2.0f * gamma);
+                float t = (zeta >= 0 ? 1.0f : -1.0f) / (fabs(zeta) + sqrt(1.0f + zeta * zeta));
+                float c = 1.0f / sqrt(1.0f + t * t);
+                float s = c * t;
+
+                for (int i = 0; i < m; ++i)
+                {
+                    float a = wp[i];
+                    float b = wq[i];
+                    wp[i] = c * a - s * b;
+                    wq[i] = s * a + c * b;
+                }
+                float *vp = Vt[p];
+                float *vq = Vt[q];
+                for (int i = 0; i < n; ++i)
+                {
+                    float a = vp[i];
+                    float b = vq[i];
+                    vp[i] = c * a - s * b;
+                    vq[i] = s * a + c * b;
+                }
             }
-            vk1 = vk1 * (1.0f / norm_vk1); // Normalize
-            if ((vk1 - vk).norm() < tolerance)
-                break;
-            vk = vk1;
         }
-        // Store the eigenvector as a column in V
-        V.setColumn(i, vk);
-        singularValues[i] = std::sqrt((vk.transpose() * AtA * vk)[0][0]); // calculate the singular value.
-        Sigma[i][i] = singularValues[i];
-
-        // Deflate AtA  (remove the contribution of the found eigenpair)
-        AtA = AtA - vk * vk.transpose() * singularValues[i] * singularValues[i];
+        if (!rotated)
+            break;
     }
 
-    Serial.println("Eigen-decomposition complete.");
-    // Sort singular values and corresponding vectors in descending order.
-    std::vector<std::pair<float, Matrix>> sv_and_v;
+    // Singular values are the column norms; sort them in descending order
+    ArenaVector<float> singularValues(n);
+    ArenaVector<int> order(n);
     for (int i = 0; i < n; ++i)
     {
-        sv_and_v.push_back(std::make_pair(singularValues[i], V.getColumn(i)));
+        singularValues[i] = kernelNorm(W[i], m);
+        order[i] = i;
     }
-    std::sort(sv_and_v.begin(), sv_and_v.end(), [](const std::pair<float, Matrix> &a, const std::pair<float, Matrix> &b)
-              { return a.first > b.first; });
-    // construct V and Sigma from the sorted pairs.
+    std::sort(order.begin(), order.end(), [&](int a, int b)
+              { return singularValues[a] > singularValues[b]; });
+
+    Matrix Sigma(m, n); // Sigma is m x n
+    Matrix V(n, n);
     for (int i = 0; i < n; ++i)
     {
-        singularValues[i] = sv_and_v[i].first;
-        V.setColumn(i, sv_and_v[i].second);
-        Sigma[i][i] = singularValues[i];
-    }
-    // 3. Compute U
-    Matrix U(m, m);
-    // Initialize U
-    Matrix AAt = A * At;
-    for (int i = 0; i < m; ++i)
-    {
-        U[i][i] = 1.0f;
+        if (i < m)
+            Sigma[i][i] = singularValues[order[i]];
+        for (int r = 0; r < n; ++r)
+        {
+            V[r][i] = Vt[order[i]][r];
+        }
     }
-    for (int i = 0; i < n; ++i)
+
+    if (uMode == SVD_NO_U)
     {
-        Matrix ui = (A * V.getColumn(i)) * (1.0f / singularValues[i]);
-        U.setColumn(i, ui);
+        return std::make_tuple(Matrix(), Sigma, V);
     }
-    if (m > n)
+
+    // u_i = A * v_i / sigma_i is the normalized i-th rotated column
+    int thinCols = std::min(m, n);
+    Matrix U(m, uMode == SVD_FULL_U ? m : thinCols);
+    int filled = 0;
+    for (int i = 0; i < thinCols; ++i)
     {
-        // Compute an orthonormal basis for the null space of A^T
-        Matrix nullspace_basis(m, m - n);
-        Matrix temp(m, m);
-        temp.set_identity();
-        for (int i = 0; i < m - n; ++i)
+        float sigma = singularValues[order[i]];
+        if (sigma <= tolerance * singularValues[order[0]])
+            break; // Null space, completed below for the full U
+        const float *w = W[order[i]];
+        for (int r = 0; r < m; ++r)
         {
-            nullspace_basis.setColumn(i, temp.getColumn(n + i));
+            U[r][i] = w[r] / sigma;
         }
-        Matrix Q, R;
-        std::tie(Q, R) = nullspace_basis.qrDecomposition();
-        for (int i = 0; i < m - n; ++i)
+        filled++;
+    }
+
+    if (uMode == SVD_FULL_U)
+    {
+        // Complete an orthonormal basis by Gram-Schmidt on the unit vectors
+        for (int k = 0; k < m && filled < m; ++k)
         {
-            U.setColumn(n + i, Q.getColumn(i));
+            ColumnView u = U.column(filled);
+            for (int r = 0; r < m; ++r)
+            {
+                u[r] = r == k ? 1.0f : 0.0f;
+            }
+            for (int j = 0; j < filled; ++j)
+            {
+                ColumnView prev = U.column(j);
+                kernelAxpy(-prev.dot(u), prev.data(), prev.stride(), u.data(), u.stride(), m);
+            }
+            float norm = u.norm();
+            if (norm < 0.5f)
+                continue; // e_k is (nearly) in the span already, try the next one
+            for (int r = 0; r < m; ++r)
+            {
+                u[r] /= norm;
+            }
+            filled++;
         }
     }
+
     return std::make_tuple(U, Sigma, V);
 }
 
@@ -191,9 +231,9 @@ bool isCoplanar(const Matrix Sigma, float threshold)
 }
 
 /**
- * @brief Check if all given 3D points are collinear using cross product.
+ * @brief Check if all given 2D or 3D points are collinear using cross product.
  *
- * @param points A matrix of 3D points (each row is a point [x, y, z]).
+ * @param points A matrix of points (each row is a point [x, y] or [x, y, z]); 2D points get z = 0.
  * @return true if collinear, false otherwise.
  */
 bool isCollinear(const Matrix &points, float threshold)
@@ -201,17 +241,20 @@ bool isCollinear(const Matrix &points, float threshold)
     if (points.rows() < 3)
         return true; // Less than 3 points are always collinear
 
+    // Rows are contiguous, so a 2D point has no third column to read
+    const bool hasZ = points.cols() > 2;
+
     // Pick the first point to compare with all others
-    float x1 = points[0][0], y1 = points[0][1], z1 = points[0][2];
+    float x1 = points[0][0], y1 = points[0][1], z1 = hasZ ? points[0][2] : 0;
 
     // Create a reference vector using the first two points
-    float x2 = points[1][0], y2 = points[1][1], z2 = points[1][2];
+    float x2 = points[1][0], y2 = points[1][1], z2 = hasZ ? points[1][2] : 0;
     float Ax = x2 - x1, Ay = y2 - y1, Az = z2 - z1;
 
     // Check all subsequent points
     for (int i = 2; i < points.rows(); ++i)
     {
-        float x3 = points[i][0], y3 = points[i][1], z3 = points[i][2];
+        float x3 = points[i][0], y3 = points[i][1], z3 = hasZ ? points[i][2] : 0;
 
         // Create vector B from the first point to the current point
         float Bx = x3 - x1, By = y3 - y1, Bz = z3 - z1;
@@ -241,12 +284,12 @@ bool isCollinear(const Matrix &points, float threshold)
  * @return Plane The plane equation coefficients
  * @note The plane is defined as ax + by + cz + d = 0
  */
-Plane findPlane(const Matrix &V, const Matrix &Centroid)
+Plane findPlane(const ConstMatrixView &V, const Matrix &Centroid)
 {
     Plane plane;
-    plane.a = V[0][2];                                                                           // Normal x
-    plane.b = V[1][2];                                                                           // Normal y
-    plane.c = V[2][2];                                                                           // Normal z
+    plane.a = V(0, 2);                                                                           // Normal x
+    plane.b = V(1, 2);                                                                           // Normal y
+    plane.c = V(2, 2);                                                                           // Normal z
     plane.d = -(plane.a * Centroid[0][0] + plane.b * Centroid[0][1] + plane.c * Centroid[0][2]); // Plane equation: ax + by + cz + d = 0
 
     return plane;
@@ -259,12 +302,12 @@ Plane findPlane(const Matrix &V, const Matrix &Centroid)
  * @param plane The plane equation coefficients
  * @return Matrix The projected points
  */
-Matrix projectPointsOntoPlane(const Matrix &points, const Plane &plane)
+Matrix projectPointsOntoPlane(const ConstMatrixView &points, const Plane &plane)
 {
     if (points.rows() == 0 || points.cols() != 3)
     {
-        Serial.println("Error: Invalid dimensions for points.");
-        return points;
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error projectPointsOntoPlane: Invalid dimensions for points.");
+        return Matrix(points);
     }
 
     float a = plane.a;
@@ -276,9 +319,9 @@ Matrix projectPointsOntoPlane(const Matrix &points, const Plane &plane)
 
     for (int i = 0; i < points.rows(); ++i)
     {
-        float x = points[i][0];
-        float y = points[i][1];
-        float z = points[i][2];
+        float x = points(i, 0);
+        float y = points(i, 1);
+        float z = points(i, 2);
 
         // Calculate the distance from the point to the plane
         float lambda = (a * x + b * y + c * z + d) / (a * a + b * b + c * c);
@@ -296,15 +339,15 @@ Matrix projectPointsOntoPlane(const Matrix &points, const Plane &plane)
  * @brief Convert a 3D point on a plane into 2D coordinates using plane basis vectors.
  *
  * @param point The 3D point (Matrix 1x3)
- * @param planeU First basis vector of the plane (Matrix 1x3)
- * @param planeV Second basis vector of the plane (Matrix 1x3)
+ * @param planeU First basis vector of the plane (3 elements, e.g. a column of V)
+ * @param planeV Second basis vector of the plane (3 elements, e.g. a column of V)
  * @return Matrix The 2D coordinates (Matrix 1x2)
  */
-Matrix convert3DTo2D(const Matrix &points, const Matrix &planeU, const Matrix &planeV)
+Matrix convert3DTo2D(const Matrix &points, const ConstColumnView &planeU, const ConstColumnView &planeV)
 {
-    if (points.cols() != 3 || planeU.cols() != 3 || planeV.cols() != 3)
+    if (points.cols() != 3 || planeU.size() != 3 || planeV.size() != 3)
     {
-        Serial.println("Error: Matrices must have 3 columns for 3D points.");
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error convert3DTo2D: Matrices must have 3 columns for 3D points.");
         return Matrix(points.rows(), 2);
     }
 
@@ -312,8 +355,8 @@ Matrix convert3DTo2D(const Matrix &points, const Matrix &planeU, const Matrix &p
     for (int i = 0; i < points.rows(); ++i)
     {
         // Project the 3D point onto the plane using the basis vectors
-        result[i][0] = points[i][0] * planeU[0][0] + points[i][1] * planeU[0][1] + points[i][2] * planeU[0][2];
-        result[i][1] = points[i][0] * planeV[0][0] + points[i][1] * planeV[0][1] + points[i][2] * planeV[0][2];
+        result[i][0] = points[i][0] * planeU[0] + points[i][1] * planeU[1] + points[i][2] * planeU[2];
+        result[i][1] = points[i][0] * planeV[0] + points[i][1] * planeV[1] + points[i][2] * planeV[2];
     }
 
     return result;
@@ -323,68 +366,67 @@ Matrix convert3DTo2D(const Matrix &points, const Matrix &planeU, const Matrix &p
  * @brief Reconstruct a 3D point from its 2D coordinates using the plane basis vectors.
  *
  * @param lsSolution2D The 2D coordinates (Matrix 1x2)
- * @param planeU First basis vector of the plane (Matrix 1x3)
- * @param planeV Second basis vector of the plane (Matrix 1x3)
+ * @param planeU First basis vector of the plane (3 elements)
+ * @param planeV Second basis vector of the plane (3 elements)
  * @return Matrix The reconstructed 3D point (Matrix 1x3)
  */
-Matrix reconstruct3D(const Matrix &lsSolution2D, const Matrix &planeU, const Matrix &planeV)
+Matrix reconstruct3D(const Matrix &lsSolution2D, const ConstColumnView &planeU, const ConstColumnView &planeV)
 {
     // Check if the input matrices have the correct dimensions
     if (lsSolution2D.cols() != 2)
     {
-        Serial.println("Error reconstruct3D: lsSolution2D must have 2 rows.");
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error reconstruct3D: lsSolution2D must have 2 columns.");
         return Matrix(1, 3);
     }
-    if (planeU.cols() != 3 || planeV.cols() != 3)
+    if (planeU.size() != 3 || planeV.size() != 3)
     {
-        Serial.println("Error reconstruct3D: planeU and planeV must have 3 columns.");
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error reconstruct3D: planeU and planeV must have 3 elements.");
         return Matrix(1, 3);
     }
 
     // Reconstruct the 3D point using the basis vectors
     Matrix result(1, 3);
-    result[0][0] = lsSolution2D[0][0] * planeU[0][0] + lsSolution2D[0][1] * planeV[0][0];
-    result[0][1] = lsSolution2D[0][0] * planeU[0][1] + lsSolution2D[0][1] * planeV[0][1];
-    result[0][2] = lsSolution2D[0][0] * planeU[0][2] + lsSolution2D[0][1] * planeV[0][2];
+    result[0][0] = lsSolution2D[0][0] * planeU[0] + lsSolution2D[0][1] * planeV[0];
+    result[0][1] = lsSolution2D[0][0] * planeU[1] + lsSolution2D[0][1] * planeV[1];
+    result[0][2] = lsSolution2D[0][0] * planeU[2] + lsSolution2D[0][1] * planeV[2];
 
     return result;
 }
 
 /**
- * @brief Solve the Least Squares using QR Decomposition
+ * @brief Solve the Least Squares using an in-place Householder QR
  *
  * @param A The matrix A
  * @param b The matrix b
- * @return Matrix The solution x
+ * @param info Optional diagnostics (residual norm, rank, condition estimate)
+ * @return Expected<Matrix> The solution x (1 x n), or why there is none
  */
-Matrix solveLeastSquares(const Matrix &A, const Matrix &b)
+Expected<Matrix> solveLeastSquares(const ConstMatrixView &A, const ConstMatrixView &b, LeastSquaresInfo *info)
 {
     if (A.rows() == 0 || A.cols() == 0 || b.rows() == 0 || b.cols() != 1)
     {
-        Serial.println("Error solveLeastSquares: Invalid dimensions for A or b.");
-        return Matrix(1, A.cols());
+        return TRACKING_EMPTY_INPUT;
     }
     if (A.rows() < A.cols())
     {
-        Serial.println("Error solveLeastSquares: More variables than equations.");
-        return Matrix(1, A.cols());
+        return TRACKING_UNDERDETERMINED;
     }
     if (A.rows() != b.rows())
     {
-        Serial.println("Error solveLeastSquares: Incompatible dimensions for A and b.");
-        return Matrix(1, A.cols());
+        return TRACKING_DIMENSION_MISMATCH;
     }
 
-    // Perform QR decomposition
-    std::pair<Matrix, Matrix> qrResult = A.qrDecomposition();
-    Matrix Q = qrResult.first;
-    Matrix R = qrResult.second;
+    // Reduce the augmented matrix [A | b] in place
+    Matrix Ab(A.rows(), A.cols() + 1);
+    copy(A, Ab.block(0, 0, A.rows(), A.cols()));
+    copy(b, Ab.block(0, A.cols(), A.rows(), 1));
 
-    // Compute Q^T * b
-    Matrix Qtb = Q.transpose() * b;
-
-    // Solve for x using inverse of R
-    Matrix result = R.inverseQR() * Qtb;
+    // The solution is written as a row, the transposed view makes it a column
+    Matrix x(1, A.cols());
+    if (!householderLeastSquaresInPlace(Ab, x.view().transpose(), info))
+    {
+        return TRACKING_RANK_DEFICIENT;
+    }
 
-    return result.transpose();
-}
\ No newline at end of file
+    return x;
+}
@@ -3,22 +3,30 @@
 
 #include <vector>
 #include "matrix.h"
+#include "factorization.h"
+
+enum SvdUMode
+{
+    SVD_NO_U,   // Only Sigma and V
+    SVD_THIN_U, // U is m x min(m, n)
+    SVD_FULL_U  // U is m x m
+};
 
 struct Plane {
     float a, b, c, d; // Plane equation: ax + by + cz + d = 0
 };
 
-Matrix computeCentroid(const Matrix &cords);
-std::pair<Matrix, Matrix> computeEquations(const Matrix &cords, const Matrix &distances);
+Matrix computeCentroid(const ConstMatrixView &cords);
+std::pair<Matrix, Matrix> computeEquations(const ConstMatrixView &cords, const ConstColumnView &distances);
 
-std::tuple<Matrix, Matrix, Matrix> svd(const Matrix &A);
+std::tuple<Matrix, Matrix, Matrix> svd(const ConstMatrixView &A, SvdUMode uMode = SVD_FULL_U, int maxSweeps = 10);
 bool isCoplanar(const Matrix Sigma, float threshold = 1e-5);
-bool isCollinear(const Matrix &Sigma, float threshold = 1e-5);
-Plane findPlane(const Matrix &V, const Matrix &Centroid);
-Matrix projectPointsOntoPlane(const Matrix &points, const Plane &plane);
-Matrix convert3DTo2D(const Matrix &points, const Matrix &planeU, const Matrix &planeV);
-Matrix reconstruct3D(const Matrix &lsSolution2D, const Matrix &planeU, const Matrix &planeV);
+bool isCollinear(const Matrix &points, float threshold = 1e-5);
+Plane findPlane(const ConstMatrixView &V, const Matrix &Centroid);
+Matrix projectPointsOntoPlane(const ConstMatrixView &points, const Plane &plane);
+Matrix convert3DTo2D(const Matrix &points, const ConstColumnView &planeU, const ConstColumnView &planeV);
+Matrix reconstruct3D(const Matrix &lsSolution2D, const ConstColumnView &planeU, const ConstColumnView &planeV);
 
-Matrix solveLeastSquares(const Matrix &A, const Matrix &b);
+Expected<Matrix> solveLeastSquares(const ConstMatrixView &A, const ConstMatrixView &b, LeastSquaresInfo *info = nullptr);
 
 #endif // LEASTSQUARE_H
\ No newline at end of file
@@ -6,8 +6,8 @@
  * Initializes an empty matrix with 0 rows and 0 columns.
  */
 Matrix::Matrix()
+    : numRows(0), numCols(0)
 {
-    matrix = std::vector<std::vector<float>>(0, std::vector<float>(0, 0));
 }
 
 /**
@@ -17,8 +17,8 @@ Matrix::Matrix()
  * @param col Number of columns
  */
 Matrix::Matrix(int row, int col)
+    : numRows(row), numCols(col), values(row * col, 0)
 {
-    matrix = std::vector<std::vector<float>>(row, std::vector<float>(col, 0));
 }
 
 /**
@@ -27,8 +27,24 @@ Matrix::Matrix(int row, int col)
  * @param input Initial values for the matrix
  */
 Matrix::Matrix(std::vector<std::vector<float>> input)
+    : numRows(input.size()), numCols(input.empty() ? 0 : input[0].size())
 {
-    matrix = input;
+    values.reserve(numRows * numCols);
+    for (const auto &row : input)
+    {
+        values.insert(values.end(), row.begin(), row.end());
+    }
+}
+
+/**
+ * @brief Matrix constructor copying the contents of a view.
+ *
+ * @param view The view to copy (may be a block or a transposed view)
+ */
+Matrix::Matrix(const ConstMatrixView &view)
+    : numRows(view.rows()), numCols(view.cols()), values(view.rows() * view.cols())
+{
+    copy(view, this->view());
 }
 
 /**
@@ -38,7 +54,7 @@ Matrix::Matrix(std::vector<std::vector<float>> input)
  */
 int Matrix::rows() const
 {
-    return matrix.size();
+    return numRows;
 }
 
 /**
@@ -48,7 +64,7 @@ int Matrix::rows() const
  */
 int Matrix::cols() const
 {
-    return matrix[0].size();
+    return numCols;
 }
 
 /**
@@ -61,23 +77,13 @@ Matrix Matrix::operator*(const Matrix &other) const
 {
     if (cols() != other.rows())
     {
-        Serial.println("Error: Matrices have incompatible dimensions for multiplication. ");
-        Serial.printf("Matrix A: %d x %d, Matrix B: %d x %d\n", rows(), cols(), other.rows(), other.cols());
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error: Matrices have incompatible dimensions for multiplication (%d x %d * %d x %d)",
+                       rows(), cols(), other.rows(), other.cols());
         return Matrix(rows(), other.cols());
     }
 
     Matrix result(rows(), other.cols());
-
-    for (int i = 0; i < rows(); ++i)
-    {
-        for (int j = 0; j < other.cols(); ++j)
-        {
-            for (int k = 0; k < cols(); ++k)
-            {
-                result.matrix[i][j] += matrix[i][k] * other.matrix[k][j];
-            }
-        }
-    }
+    multiply(view(), other.view(), result.view());
     return result;
 }
 
@@ -88,12 +94,9 @@ Matrix Matrix::operator*(const Matrix &other) const
  */
 void Matrix::operator*=(float val)
 {
-    for (size_t y = 0; y < rows(); y++)
+    for (float &value : values)
     {
-        for (size_t x = 0; x < cols(); x++)
-        {
-            matrix[y][x] *= val;
-        }
+        value *= val;
     }
 }
 
@@ -106,52 +109,13 @@ void Matrix::operator*=(float val)
 Matrix Matrix::operator*(float val) const
 {
     Matrix result(rows(), cols());
-    for (size_t y = 0; y < rows(); y++)
+    for (size_t i = 0; i < values.size(); i++)
     {
-        for (size_t x = 0; x < cols(); x++)
-        {
-            result[y][x] = matrix[y][x] * val;
-        }
+        result.values[i] = values[i] * val;
     }
     return result;
 }
 
-/**
- * @brief Overload [] to return a reference to a row
- *
- * @param row The row index
- * @return std::vector<float>& The row vector
- */
-std::vector<float> &Matrix::operator[](int row)
-{
-    if (row < 0 || row >= rows())
-    {
-        Serial.print("Error: Row index out of bounds. ");
-        Serial.printf("Requested row: %d, but matrix has %d rows.\n", row, rows());
-        return Matrix(rows(), 1)[0]; // Return vector with default values as a fallback
-    }
-
-    return matrix[row];
-}
-
-/**
- * @brief Overload [] to return a reference to a row
- *
- * @param row The row index
- * @return const std::vector<float>& The row vector
- */
-const std::vector<float> &Matrix::operator[](int row) const
-{
-    if (row < 0 || row >= rows())
-    {
-        Serial.print("Error: Row index out of bounds. ");
-        Serial.printf("Requested row: %d, but matrix has %d rows.\n", row, rows());
-        return Matrix(rows(), 1)[0]; // Return vector with default values as a fallback
-    }
-
-    return matrix[row];
-}
-
 /**
  * @brief Get a column from the matrix
  *
@@ -162,8 +126,7 @@ Matrix Matrix::getColumn(int colIndex) const
 {
     if (colIndex < 0 || colIndex >= cols())
     {
-        Serial.print("Error: Column index out of bounds. ");
-        Serial.printf("Requested column: %d, but matrix has %d columns.\n", colIndex, cols());
+        TRACKING_ERROR(TRACKING_INDEX_OUT_OF_RANGE, "Error getColumn: Column %d out of bounds, matrix has %d columns.", colIndex, cols());
         return Matrix(rows(), 1); // Return column vector with default values as a fallback
     }
 
@@ -171,7 +134,7 @@ Matrix Matrix::getColumn(int colIndex) const
 
     for (int i = 0; i < rows(); ++i)
     {
-        columnVector[i][0] = this->matrix[i][colIndex]; // Copy column values
+        columnVector[i][0] = (*this)[i][colIndex]; // Copy column values
     }
 
     return columnVector;
@@ -188,13 +151,13 @@ void Matrix::setColumn(int colIndex, const Matrix &col)
     if (col.rows() != this->rows())
     {
         // Handle error: the number of rows in the column must match the number of rows in the matrix
-        Serial.println("Error: Column dimensions do not match matrix dimensions.");
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error setColumn: Column dimensions do not match matrix dimensions.");
         return;
     }
 
     for (int i = 0; i < this->rows(); ++i)
     {
-        this->matrix[i][colIndex] = col[i][0]; // Update the matrix with the new column values
+        (*this)[i][colIndex] = col[i][0]; // Update the matrix with the new column values
     }
 }
 
@@ -208,19 +171,16 @@ Matrix Matrix::operator+(const Matrix &other) const
 {
     if (rows() != other.rows() || cols() != other.cols())
     {
-        Serial.println("Error: Matrices have incompatible dimensions for addition.");
-        Serial.printf("Matrix A: %d x %d, Matrix B: %d x %d\n", rows(), cols(), other.rows(), other.cols());
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error: Matrices have incompatible dimensions for addition (%d x %d + %d x %d)",
+                       rows(), cols(), other.rows(), other.cols());
         return Matrix(rows(), cols());
     }
 
     Matrix result(rows(), cols());
 
-    for (int y = 0; y < rows(); ++y)
+    for (size_t i = 0; i < values.size(); ++i)
     {
-        for (int x = 0; x < cols(); ++x)
-        {
-            result.matrix[y][x] = matrix[y][x] + other.matrix[y][x];
-        }
+        result.values[i] = values[i] + other.values[i];
     }
     return result;
 }
@@ -235,19 +195,16 @@ Matrix Matrix::operator-(const Matrix &other) const
 {
     if (rows() != other.rows() || cols() != other.cols())
     {
-        Serial.println("Error: Matrices have incompatible dimensions for subtraction.");
-        Serial.printf("Matrix A: %d x %d, Matrix B: %d x %d\n", rows(), cols(), other.rows(), other.cols());
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error: Matrices have incompatible dimensions for subtraction (%d x %d - %d x %d)",
+                       rows(), cols(), other.rows(), other.cols());
         return Matrix(rows(), cols());
     }
 
     Matrix result(rows(), cols());
 
-    for (int y = 0; y < rows(); ++y)
+    for (size_t i = 0; i < values.size(); ++i)
     {
-        for (int x = 0; x < cols(); ++x)
-        {
-            result.matrix[y][x] = matrix[y][x] - other.matrix[y][x];
-        }
+        result.values[i] = values[i] - other.values[i];
     }
     return result;
 }
@@ -261,7 +218,7 @@ void Matrix::print() const
     {
         for (size_t j = 0; j < cols(); ++j)
         {
-            Serial.print(matrix[i][j]);
+            Serial.print((*this)[i][j]);
             Serial.print(" ");
         }
         Serial.println();
@@ -275,13 +232,7 @@ void Matrix::print() const
  */
 void Matrix::set_value(float val)
 {
-    for (size_t y = 0; y < rows(); y++)
-    {
-        for (size_t x = 0; x < cols(); x++)
-        {
-            matrix[y][x] = val;
-        }
-    }
+    std::fill(values.begin(), values.end(), val);
 }
 
 /**
@@ -296,19 +247,19 @@ void Matrix::set_identity(float scale, int size, int y, int x)
 {
     if (size < 0)
     {
-        Serial.println("Error set_identity: Size cannot be negative.");
+        TRACKING_ERROR(TRACKING_INDEX_OUT_OF_RANGE, "Error set_identity: Size cannot be negative.");
         return;
     }
 
     if (y < 0 || x < 0 || y >= rows() || x >= cols())
     {
-        Serial.println("Error set_identity: Starting position is out of bounds.");
+        TRACKING_ERROR(TRACKING_INDEX_OUT_OF_RANGE, "Error set_identity: Starting position is out of bounds.");
         return;
     }
 
     if (size > std::min(rows() - y, cols() - x))
     {
-        Serial.println("Error set_identity: Size too big for the space that was provided.");
+        TRACKING_ERROR(TRACKING_INDEX_OUT_OF_RANGE, "Error set_identity: Size too big for the space that was provided.");
         return;
     }
 
@@ -320,7 +271,7 @@ void Matrix::set_identity(float scale, int size, int y, int x)
     set_value(0);
     for (size_t i = 0; i < size; i++)
     {
-        matrix[i + y][i + x] = scale;
+        (*this)[i + y][i + x] = scale;
     }
 }
 
@@ -331,17 +282,7 @@ void Matrix::set_identity(float scale, int size, int y, int x)
  */
 float Matrix::norm() const
 {
-    float sum = 0.0;
-
-    for (const auto &row : matrix)
-    {
-        for (float val : row)
-        {
-            sum += val * val; // Square each element
-        }
-    }
-
-    return sqrt(sum); // Take the square root
+    return kernelNorm(values.data(), values.size());
 }
 
 /**
@@ -351,16 +292,7 @@ float Matrix::norm() const
  */
 Matrix Matrix::transpose() const
 {
-    Matrix transposed(cols(), rows());
-
-    for (size_t y = 0; y < cols(); y++)
-    {
-        for (size_t x = 0; x < rows(); x++)
-        {
-            transposed[y][x] = matrix[x][y];
-        }
-    }
-    return transposed;
+    return Matrix(view().transpose());
 }
 
 /**
@@ -375,26 +307,17 @@ Matrix Matrix::gaussJordanInverse() const
     // Check if the matrix is square
     if (n != cols())
     {
-        Serial.println("Error gaussJordanInverse: Matrix must be square to compute inverse.");
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error gaussJordanInverse: Matrix must be square to compute inverse.");
         return Matrix(rows(), cols());
     }
 
-    for (int i = 0; i < n; ++i)
-    {
-        if (matrix[i][i] == 0.0)
-        {
-            Serial.println("Error gaussJordanInverse: Singular matrix detected during Gauss-Jordan elimination.");
-            return Matrix(n, n);
-        }
-    }
-
     // Create an augmented matrix [A | I]
     Matrix augmented(n, n * 2);
     for (int y = 0; y < n; ++y)
     {
         for (int x = 0; x < n; ++x)
         {
-            augmented[y][x] = matrix[y][x]; // Copy original matrix
+            augmented[y][x] = (*this)[y][x]; // Copy original matrix
         }
         augmented[y][n + y] = 1.0; // Identity matrix on the right
     }
@@ -402,12 +325,23 @@ Matrix Matrix::gaussJordanInverse() const
     // Perform row operations to transform [A | I] -> [I | A^-1]
     for (int i = 0; i < n; ++i)
     {
-        // Find the pivot row
+        // Find the pivot row (largest magnitude in column i) and swap it up
+        int pivotRow = i;
+        for (int k = i + 1; k < n; ++k)
+        {
+            if (fabs(augmented[k][i]) > fabs(augmented[pivotRow][i]))
+                pivotRow = k;
+        }
+        if (pivotRow != i)
+        {
+            std::swap_ranges(augmented[i], augmented[i] + 2 * n, augmented[pivotRow]);
+        }
+
         float pivot = augmented[i][i];
         if (pivot == 0.0)
         {
-            Serial.println("Error gaussJordanInverse: Singular matrix (non-invertible).");
-            return Matrix(n, n); // Return original matrix as a fallback
+            TRACKING_ERROR(TRACKING_SINGULAR, "Error gaussJordanInverse: Singular matrix (non-invertible).");
+            return Matrix(n, n); // Return zero matrix as a fallback
         }
 
         // Normalize pivot row
@@ -450,57 +384,12 @@ Matrix Matrix::gaussJordanInverse() const
  */
 std::pair<Matrix, Matrix> Matrix::qrDecomposition() const
 {
-    if (rows() == 0 || cols() == 0)
-    {
-        Serial.println("Error qrDecomposition: Matrix is empty.");
-        return {Matrix(rows(), cols()), Matrix(cols(), cols())};
-    }
-
-    // Initialize correct sizes
     Matrix Q(rows(), cols());
     Matrix R(cols(), cols());
 
-    // Perform Gram-Schmidt
-    for (int j = 0; j < cols(); ++j)
+    if (!::qrDecomposition(view(), Q.view(), R.view()))
     {
-
-        // Step 1: Extract j-th column of A
-        Matrix v = getColumn(j);
-
-        // Step 2: Orthogonalization
-        for (int k = 0; k < j; ++k)
-        {
-            float dot = 0;
-            for (int i = 0; i < rows(); ++i)
-            {
-                dot += Q[i][k] * matrix[i][j];
-            }
-            R[k][j] = dot;
-            for (int i = 0; i < rows(); ++i)
-            {
-                v[i][0] -= dot * Q[i][k];
-            }
-        }
-
-        // Step 3: Normalize
-        float norm = 0;
-        for (int i = 0; i < rows(); ++i)
-        {
-            norm += v[i][0] * v[i][0];
-        }
-        norm = sqrt(norm);
-
-        if (norm == 0)
-        {
-            Serial.println("Error qrDecomposition: Zero norm encountered during QR decomposition.");
-            return {Matrix(rows(), cols()), Matrix(cols(), cols())};
-        }
-
-        R[j][j] = norm;
-        for (int i = 0; i < rows(); ++i)
-        {
-            Q[i][j] = v[i][0] / norm;
-        }
+        return {Matrix(rows(), cols()), Matrix(cols(), cols())};
     }
     return {Q, R};
 }
@@ -517,15 +406,15 @@ Matrix Matrix::inverseQR() const
     // Check if the matrix is square
     if (n != cols())
     {
-        Serial.println("Error inverseQR: Matrix must be square to compute inverse.");
+        TRACKING_ERROR(TRACKING_DIMENSION_MISMATCH, "Error inverseQR: Matrix must be square to compute inverse.");
         return Matrix(rows(), cols());
     }
 
     for (int i = 0; i < n; ++i)
     {
-        if (matrix[i][i] == 0.0)
+        if ((*this)[i][i] == 0.0)
         {
-            Serial.println("Error inverseQR: Singular matrix detected during Gauss-Jordan elimination.");
+            TRACKING_ERROR(TRACKING_SINGULAR, "Error inverseQR: Singular matrix detected during Gauss-Jordan elimination.");
             return Matrix(n, n);
         }
     }
@@ -538,32 +427,136 @@ Matrix Matrix::inverseQR() const
     // Initialize inverse matrix
     Matrix inverse(n, n);
 
-    // Solve R * X = Q^T * I (column-wise)
-    Matrix Qt = Q.transpose();
+    // Solve R * X = Q^T * I (column-wise). Q^T * e_j is simply row j of Q.
     for (int j = 0; j < n; ++j)
     {
-        Matrix e(n, 1);
-        e[j][0] = 1.0; // Column of identity matrix
-
-        Matrix b = Qt * e; // Compute Q^T * e_j
-
-        // Back-substitution to solve R * x = b
+        // Back-substitution to solve R * x = Q^T * e_j
         for (int i = n - 1; i >= 0; --i)
         {
-            if (R.matrix[i][i] == 0.0)
+            if (R[i][i] == 0.0)
             {
-                Serial.println("Error inverseQR: Singular matrix in upper triangular solve.");
+                TRACKING_ERROR(TRACKING_SINGULAR, "Error inverseQR: Singular matrix in upper triangular solve.");
                 return Matrix(n, n);
             }
 
             float sum = 0.0;
             for (int k = i + 1; k < n; ++k)
             {
-                sum += R.matrix[i][k] * inverse[k][j];
+                sum += R[i][k] * inverse[k][j];
             }
-            inverse[i][j] = (b[i][0] - sum) / R.matrix[i][i];
+            inverse[i][j] = (Q[j][i] - sum) / R[i][i];
         }
     }
 
     return inverse;
 }
+
+/**
+ * @brief Multiply two matrix views into a preallocated result view
+ *
+ * @param a Left operand (m x k)
+ * @param b Right operand (k x n)
+ * @param result Destination (m x n), must not alias a or b
+ */
+void multiply(const ConstMatrixView &a, const ConstMatrixView &b, const MatrixView &result)
+{
+    if (a.isContiguous() && b.isContiguous() && result.isContiguous())
+    {
+        if (b.cols() == 1)
+            kernelGemv(a.data(), b.data(), result.data(), a.rows(), a.cols());
+        else
+            kernelGemm(a.data(), b.data(), result.data(), a.rows(), a.cols(), b.cols());
+        return;
+    }
+
+    // Strided operands (blocks, transposes): one strided dot product per element
+    for (int i = 0; i < a.rows(); ++i)
+    {
+        for (int j = 0; j < b.cols(); ++j)
+        {
+            result(i, j) = kernelDotStrided(&a(i, 0), a.colStride(), &b(0, j), b.rowStride(), a.cols());
+        }
+    }
+}
+
+/**
+ * @brief Copy the contents of one view into another of the same size
+ *
+ * @param source The view to copy from
+ * @param destination The view to copy into
+ */
+void copy(const ConstMatrixView &source, const MatrixView &destination)
+{
+    for (int i = 0; i < source.rows(); ++i)
+    {
+        for (int j = 0; j < source.cols(); ++j)
+        {
+            destination(i, j) = source(i, j);
+        }
+    }
+}
+
+/**
+ * @brief Compute the QR decomposition (Gram-Schmidt) into preallocated views
+ *
+ * Works on any block or column subset of a matrix; the columns of Q are
+ * orthogonalized in place, so no temporaries are allocated.
+ *
+ * @param A The input matrix (m x n)
+ * @param Q Destination for Q (m x n)
+ * @param R Destination for R (n x n)
+ * @return true on success, false if A is empty or rank deficient
+ */
+bool qrDecomposition(const ConstMatrixView &A, const MatrixView &Q, const MatrixView &R)
+{
+    if (A.rows() == 0 || A.cols() == 0)
+    {
+        TRACKING_ERROR(TRACKING_EMPTY_INPUT, "Error qrDecomposition: Matrix is empty.");
+        return false;
+    }
+
+    for (int i = 0; i < R.rows(); ++i)
+    {
+        for (int j = 0; j < R.cols(); ++j)
+        {
+            R(i, j) = 0;
+        }
+    }
+
+    // Perform Gram-Schmidt
+    for (int j = 0; j < A.cols(); ++j)
+    {
+        // Step 1: Extract j-th column of A into the j-th column of Q
+        ColumnView v = Q.column(j);
+        ConstColumnView a = A.column(j);
+        for (int i = 0; i < A.rows(); ++i)
+        {
+            v[i] = a[i];
+        }
+
+        // Step 2: Orthogonalization
+        for (int k = 0; k < j; ++k)
+        {
+            ColumnView q = Q.column(k);
+            float dot = q.dot(a);
+            R(k, j) = dot;
+            kernelAxpy(-dot, q.data(), q.stride(), v.data(), v.stride(), A.rows());
+        }
+
+        // Step 3: Normalize
+        float norm = v.norm();
+
+        if (norm == 0)
+        {
+            TRACKING_ERROR(TRACKING_RANK_DEFICIENT, "Error qrDecomposition: Zero norm encountered during QR decomposition.");
+            return false;
+        }
+
+        R(j, j) = norm;
+        for (int i = 0; i < A.rows(); ++i)
+        {
+            v[i] /= norm;
+        }
+    }
+    return true;
+}
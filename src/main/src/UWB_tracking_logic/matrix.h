@@ -3,25 +3,153 @@
 
 #include <Arduino.h>
 #include <vector>
+#include "arena.h"
+#include "kernels.h"
+#include "status.h"
 
+template <typename T>
+class BasicColumnView;
+
+/**
+ * @brief Non-owning strided view of a matrix or of a sub-block of one.
+ *
+ * Element (row, col) lives at data[row * rowStride + col * colStride], so
+ * blocks, rows and transposes are all views into the same buffer and never
+ * allocate. T is float for a mutable view and const float for a read-only one.
+ */
+template <typename T>
+class BasicMatrixView
+{
+public:
+    BasicMatrixView(T *data, int rows, int cols, int rowStride, int colStride = 1)
+        : ptr(data), numRows(rows), numCols(cols), rStride(rowStride), cStride(colStride) {}
+
+    // Allow MatrixView -> ConstMatrixView
+    template <typename U>
+    BasicMatrixView(const BasicMatrixView<U> &other)
+        : ptr(other.data()), numRows(other.rows()), numCols(other.cols()),
+          rStride(other.rowStride()), cStride(other.colStride()) {}
+
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+    int rowStride() const { return rStride; }
+    int colStride() const { return cStride; }
+    T *data() const { return ptr; }
+
+    T &operator()(int row, int col) const { return ptr[row * rStride + col * cStride]; }
+    bool isContiguous() const { return cStride == 1 && rStride == numCols; }
+
+    BasicMatrixView block(int row, int col, int rows, int cols) const
+    {
+        return BasicMatrixView(ptr + row * rStride + col * cStride, rows, cols, rStride, cStride);
+    }
+    BasicMatrixView transpose() const { return BasicMatrixView(ptr, numCols, numRows, cStride, rStride); }
+    BasicColumnView<T> column(int col) const;
+    BasicColumnView<T> row(int row) const;
+
+private:
+    T *ptr;
+    int numRows;
+    int numCols;
+    int rStride;
+    int cStride;
+};
+
+/**
+ * @brief Non-owning strided view of a single column (or row) vector.
+ */
+template <typename T>
+class BasicColumnView
+{
+public:
+    BasicColumnView(T *data, int size, int stride = 1)
+        : ptr(data), length(size), step(stride) {}
+
+    // Allow ColumnView -> ConstColumnView
+    template <typename U>
+    BasicColumnView(const BasicColumnView<U> &other)
+        : ptr(other.data()), length(other.size()), step(other.stride()) {}
+
+    int size() const { return length; }
+    int stride() const { return step; }
+    T *data() const { return ptr; }
+
+    T &operator[](int i) const { return ptr[i * step]; }
+
+    /**
+     * @brief Dot product with another vector of the same length
+     */
+    template <typename U>
+    float dot(const BasicColumnView<U> &other) const
+    {
+        return kernelDotStrided(ptr, step, other.data(), other.stride(), length);
+    }
+
+    float norm() const { return sqrt(dot(*this)); }
+
+private:
+    T *ptr;
+    int length;
+    int step;
+};
+
+template <typename T>
+BasicColumnView<T> BasicMatrixView<T>::column(int col) const
+{
+    return BasicColumnView<T>(ptr + col * cStride, numRows, rStride);
+}
+
+template <typename T>
+BasicColumnView<T> BasicMatrixView<T>::row(int row) const
+{
+    return BasicColumnView<T>(ptr + row * rStride, numCols, cStride);
+}
+
+using MatrixView = BasicMatrixView<float>;
+using ConstMatrixView = BasicMatrixView<const float>;
+using ColumnView = BasicColumnView<float>;
+using ConstColumnView = BasicColumnView<const float>;
+
+/**
+ * @brief Dense matrix stored in a single row-major buffer.
+ *
+ * Storage comes from the active arena when one is open (see ArenaScope), so
+ * the temporaries of a localization cycle never touch the heap.
+ */
 class Matrix
 {
 public:
-    std::vector<std::vector<float>> matrix;
+    typedef float Scalar;
 
     Matrix();
     Matrix(int row, int col);
     Matrix(std::vector<std::vector<float>> input);
+    Matrix(const ConstMatrixView &view);
 
     int rows() const;
     int cols() const;
 
+    float *data() { return values.data(); }
+    const float *data() const { return values.data(); }
+
+    MatrixView view() { return MatrixView(values.data(), numRows, numCols, numCols); }
+    ConstMatrixView view() const { return ConstMatrixView(values.data(), numRows, numCols, numCols); }
+    operator MatrixView() { return view(); }
+    operator ConstMatrixView() const { return view(); }
+
+    MatrixView block(int row, int col, int rows, int cols) { return view().block(row, col, rows, cols); }
+    ConstMatrixView block(int row, int col, int rows, int cols) const { return view().block(row, col, rows, cols); }
+    ColumnView column(int col) { return view().column(col); }
+    ConstColumnView column(int col) const { return view().column(col); }
+
     Matrix operator*(const Matrix &other) const;
     void operator*=(float val);
     Matrix operator*(float val) const;
 
-    std::vector<float> &operator[](int row);
-    const std::vector<float> &operator[](int row) const;
+    float *operator[](int row) { return values.data() + row * numCols; }
+    const float *operator[](int row) const { return values.data() + row * numCols; }
+    float &operator()(int row, int col) { return values[row * numCols + col]; }
+    float operator()(int row, int col) const { return values[row * numCols + col]; }
     Matrix getColumn(int colIndex) const;
     void setColumn(int colIndex, const Matrix &col);
 
@@ -32,13 +160,22 @@ public:
 
     void set_value(float val);
     void set_identity(float scale = 1, int size = 0, int y = 0, int x = 0);
-    
+
     float norm() const;
     Matrix transpose() const;
     Matrix gaussJordanInverse() const;
 
     std::pair<Matrix, Matrix> qrDecomposition() const;
     Matrix inverseQR() const;
+
+private:
+    int numRows;
+    int numCols;
+    ArenaVector<float> values; // Row-major, rows() * cols() elements
 };
 
-#endif // MATRIX_H
\ No newline at end of file
+void multiply(const ConstMatrixView &a, const ConstMatrixView &b, const MatrixView &result);
+void copy(const ConstMatrixView &source, const MatrixView &destination);
+bool qrDecomposition(const ConstMatrixView &A, const MatrixView &Q, const MatrixView &R);
+
+#endif // MATRIX_H
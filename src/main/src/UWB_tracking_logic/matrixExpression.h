@@ -0,0 +1,324 @@
+#ifndef MATRIX_EXPRESSION_H
+#define MATRIX_EXPRESSION_H
+
+/*
+ * Lazy expression templates for FixedMatrix.
+ *
+ * Operators on FixedMatrix build small expression objects instead of result
+ * matrices. Assigning an expression evaluates it row by row straight into the
+ * destination: a product only keeps one row of its left operand in a stack
+ * buffer, so F * P * F.transpose() + Q runs as one loop nest per output row
+ * without any intermediate matrix.
+ *
+ * Right-hand operands of a product are read by coefficient, so keep nested
+ * products on the left (the natural left-to-right grouping of a * b * c).
+ * Expressions hold references to their operands and must be evaluated within
+ * the same statement; never store one in an `auto` variable.
+ *
+ * Every node carries the Scalar type of its operands (float, double or a
+ * FixedPoint type), so the same expressions serve all tracking builds.
+ */
+
+template <int R, int C, typename T>
+class FixedMatrix;
+
+template <typename E>
+class TransposeExpr;
+
+/**
+ * @brief CRTP base of every matrix expression.
+ *
+ * Derived types provide Scalar, Rows, Cols, coeff(i, j) and evalRow(i, out).
+ */
+template <typename Derived>
+class MatrixExpression
+{
+public:
+    const Derived &derived() const { return static_cast<const Derived &>(*this); }
+
+    // Templated so the return type is only looked up once Derived is complete
+    template <typename D = Derived>
+    typename D::Scalar operator()(int row, int col) const { return derived().coeff(row, col); }
+
+    TransposeExpr<Derived> transpose() const { return TransposeExpr<Derived>(derived()); }
+};
+
+/**
+ * @brief How an expression stores its operands: matrices by reference,
+ * (lightweight) expression nodes by value.
+ */
+template <typename E>
+struct ExpressionOperand
+{
+    typedef const E type;
+};
+
+template <int R, int C, typename T>
+struct ExpressionOperand<FixedMatrix<R, C, T>>
+{
+    typedef const FixedMatrix<R, C, T> &type;
+};
+
+/**
+ * @brief Evaluate one row of an expression coefficient by coefficient
+ */
+template <typename E>
+inline void evalRowByCoeff(const E &expr, int row, typename E::Scalar *out)
+{
+#pragma GCC unroll 6
+    for (int j = 0; j < E::Cols; ++j)
+    {
+        out[j] = expr.coeff(row, j);
+    }
+}
+
+/**
+ * @brief Matrix that selects a contiguous block of a vector, e.g. the
+ * measurement matrix H = [I 0] picking the position out of [pos, vel].
+ *
+ * Element (i, j) is 1 when j == i + Offset and 0 otherwise. It has no storage,
+ * and products with it reduce to row/column selection.
+ */
+template <int R, int C, int Offset = 0, typename T = float>
+class SelectionMatrix : public MatrixExpression<SelectionMatrix<R, C, Offset, T>>
+{
+public:
+    typedef T Scalar;
+    static const int Rows = R;
+    static const int Cols = C;
+
+    T coeff(int row, int col) const { return col == row + Offset ? T(1) : T(0); }
+    void evalRow(int row, T *out) const { evalRowByCoeff(*this, row, out); }
+};
+
+template <typename E>
+class TransposeExpr : public MatrixExpression<TransposeExpr<E>>
+{
+public:
+    typedef typename E::Scalar Scalar;
+    static const int Rows = E::Cols;
+    static const int Cols = E::Rows;
+
+    explicit TransposeExpr(const E &expr) : expr(expr) {}
+
+    Scalar coeff(int row, int col) const { return expr.coeff(col, row); }
+    void evalRow(int row, Scalar *out) const { evalRowByCoeff(*this, row, out); }
+
+private:
+    typename ExpressionOperand<E>::type expr;
+};
+
+template <typename A, typename B>
+class SumExpr : public MatrixExpression<SumExpr<A, B>>
+{
+public:
+    typedef typename A::Scalar Scalar;
+    static const int Rows = A::Rows;
+    static const int Cols = A::Cols;
+    static_assert(A::Rows == B::Rows && A::Cols == B::Cols, "Matrices have incompatible dimensions for addition");
+
+    SumExpr(const A &a, const B &b) : a(a), b(b) {}
+
+    Scalar coeff(int row, int col) const { return a.coeff(row, col) + b.coeff(row, col); }
+    void evalRow(int row, Scalar *out) const
+    {
+        Scalar other[Cols];
+        a.evalRow(row, out);
+        b.evalRow(row, other);
+#pragma GCC unroll 6
+        for (int j = 0; j < Cols; ++j)
+        {
+            out[j] += other[j];
+        }
+    }
+
+private:
+    typename ExpressionOperand<A>::type a;
+    typename ExpressionOperand<B>::type b;
+};
+
+template <typename A, typename B>
+class DifferenceExpr : public MatrixExpression<DifferenceExpr<A, B>>
+{
+public:
+    typedef typename A::Scalar Scalar;
+    static const int Rows = A::Rows;
+    static const int Cols = A::Cols;
+    static_assert(A::Rows == B::Rows && A::Cols == B::Cols, "Matrices have incompatible dimensions for subtraction");
+
+    DifferenceExpr(const A &a, const B &b) : a(a), b(b) {}
+
+    Scalar coeff(int row, int col) const { return a.coeff(row, col) - b.coeff(row, col); }
+    void evalRow(int row, Scalar *out) const
+    {
+        Scalar other[Cols];
+        a.evalRow(row, out);
+        b.evalRow(row, other);
+#pragma GCC unroll 6
+        for (int j = 0; j < Cols; ++j)
+        {
+            out[j] -= other[j];
+        }
+    }
+
+private:
+    typename ExpressionOperand<A>::type a;
+    typename ExpressionOperand<B>::type b;
+};
+
+template <typename E>
+class ScaledExpr : public MatrixExpression<ScaledExpr<E>>
+{
+public:
+    typedef typename E::Scalar Scalar;
+    static const int Rows = E::Rows;
+    static const int Cols = E::Cols;
+
+    ScaledExpr(const E &expr, Scalar scale) : expr(expr), scale(scale) {}
+
+    Scalar coeff(int row, int col) const { return expr.coeff(row, col) * scale; }
+    void evalRow(int row, Scalar *out) const
+    {
+        expr.evalRow(row, out);
+#pragma GCC unroll 6
+        for (int j = 0; j < Cols; ++j)
+        {
+            out[j] *= scale;
+        }
+    }
+
+private:
+    typename ExpressionOperand<E>::type expr;
+    Scalar scale;
+};
+
+/**
+ * @brief General product. One row of A is evaluated into a stack buffer and
+ * combined with B's coefficients.
+ */
+template <typename A, typename B>
+class ProductExpr : public MatrixExpression<ProductExpr<A, B>>
+{
+public:
+    typedef typename A::Scalar Scalar;
+    static const int Rows = A::Rows;
+    static const int Cols = B::Cols;
+    static_assert(A::Cols == B::Rows, "Matrices have incompatible dimensions for multiplication");
+
+    ProductExpr(const A &a, const B &b) : a(a), b(b) {}
+
+    Scalar coeff(int row, int col) const
+    {
+        Scalar sum = 0;
+#pragma GCC unroll 6
+        for (int k = 0; k < A::Cols; ++k)
+        {
+            sum += a.coeff(row, k) * b.coeff(k, col);
+        }
+        return sum;
+    }
+
+    void evalRow(int row, Scalar *out) const
+    {
+        Scalar left[A::Cols];
+        a.evalRow(row, left);
+#pragma GCC unroll 6
+        for (int j = 0; j < Cols; ++j)
+        {
+            Scalar sum = 0;
+#pragma GCC unroll 6
+            for (int k = 0; k < A::Cols; ++k)
+            {
+                sum += left[k] * b.coeff(k, j);
+            }
+            out[j] = sum;
+        }
+    }
+
+private:
+    typename ExpressionOperand<A>::type a;
+    typename ExpressionOperand<B>::type b;
+};
+
+/**
+ * @brief H * B with H a selection matrix: rows Offset.. of B.
+ */
+template <int R, int C, int Offset, typename T, typename B>
+class ProductExpr<SelectionMatrix<R, C, Offset, T>, B> : public MatrixExpression<ProductExpr<SelectionMatrix<R, C, Offset, T>, B>>
+{
+public:
+    typedef typename B::Scalar Scalar;
+    static const int Rows = R;
+    static const int Cols = B::Cols;
+    static_assert(C == B::Rows, "Matrices have incompatible dimensions for multiplication");
+
+    ProductExpr(const SelectionMatrix<R, C, Offset, T> &, const B &b) : b(b) {}
+
+    Scalar coeff(int row, int col) const { return b.coeff(row + Offset, col); }
+    void evalRow(int row, Scalar *out) const { b.evalRow(row + Offset, out); }
+
+private:
+    typename ExpressionOperand<B>::type b;
+};
+
+/**
+ * @brief A * H^T with H a selection matrix: columns Offset.. of A.
+ */
+template <typename A, int R, int C, int Offset, typename T>
+class ProductExpr<A, TransposeExpr<SelectionMatrix<R, C, Offset, T>>> : public MatrixExpression<ProductExpr<A, TransposeExpr<SelectionMatrix<R, C, Offset, T>>>>
+{
+public:
+    typedef typename A::Scalar Scalar;
+    static const int Rows = A::Rows;
+    static const int Cols = R;
+    static_assert(A::Cols == C, "Matrices have incompatible dimensions for multiplication");
+
+    ProductExpr(const A &a, const TransposeExpr<SelectionMatrix<R, C, Offset, T>> &) : a(a) {}
+
+    Scalar coeff(int row, int col) const { return a.coeff(row, col + Offset); }
+    void evalRow(int row, Scalar *out) const
+    {
+        Scalar full[A::Cols];
+        a.evalRow(row, full);
+#pragma GCC unroll 6
+        for (int j = 0; j < Cols; ++j)
+        {
+            out[j] = full[j + Offset];
+        }
+    }
+
+private:
+    typename ExpressionOperand<A>::type a;
+};
+
+template <typename A, typename B>
+inline SumExpr<A, B> operator+(const MatrixExpression<A> &a, const MatrixExpression<B> &b)
+{
+    return SumExpr<A, B>(a.derived(), b.derived());
+}
+
+template <typename A, typename B>
+inline DifferenceExpr<A, B> operator-(const MatrixExpression<A> &a, const MatrixExpression<B> &b)
+{
+    return DifferenceExpr<A, B>(a.derived(), b.derived());
+}
+
+template <typename A, typename B>
+inline ProductExpr<A, B> operator*(const MatrixExpression<A> &a, const MatrixExpression<B> &b)
+{
+    return ProductExpr<A, B>(a.derived(), b.derived());
+}
+
+template <typename E>
+inline ScaledExpr<E> operator*(const MatrixExpression<E> &expr, typename E::Scalar scale)
+{
+    return ScaledExpr<E>(expr.derived(), scale);
+}
+
+template <typename E>
+inline ScaledExpr<E> operator*(typename E::Scalar scale, const MatrixExpression<E> &expr)
+{
+    return ScaledExpr<E>(expr.derived(), scale);
+}
+
+#endif // MATRIX_EXPRESSION_H
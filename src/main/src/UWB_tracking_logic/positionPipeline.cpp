@@ -0,0 +1,265 @@
+#include "positionPipeline.h"
+#include <algorithm>
+
+/**
+ * @brief Record one measurement
+ */
+void StageTiming::add(uint32_t us)
+{
+    ++count;
+    totalUs += us;
+    maxUs = std::max(maxUs, us);
+}
+
+/**
+ * @brief Forget all measurements
+ */
+void StageTiming::reset()
+{
+    count = 0;
+    totalUs = 0;
+    maxUs = 0;
+}
+
+/**
+ * @brief Create a pipeline feeding a tracker.
+ *
+ * @param tracker Anchor registry, solver and Kalman filter; its anchors must be registered
+ */
+PositionPipeline::PositionPipeline(trilateration &tracker)
+    : tracker(tracker), listener(nullptr), policy(BATCH_PER_ROUND), intervalMs(BATCH_INTERVAL_MS), batchCount(0),
+      batchRound(AUTO_ROUND), batchStartMs(0), batchLastUs(0), lastSolveMs(0), head(0), count(0), fix(), fixes(0)
+{
+    resetStats();
+}
+
+/**
+ * @brief Queue a range; cheap enough for the ranging callback.
+ *
+ * @param anchorId Short address of the anchor
+ * @param range Measured distance
+ * @param round ID of the ranging round, or AUTO_ROUND
+ * @return true if queued, false if the queue was full and the range dropped
+ */
+bool PositionPipeline::pushRange(uint16_t anchorId, float range, uint16_t round)
+{
+    ++received;
+    if (count == RANGE_QUEUE_SIZE)
+    {
+        ++dropped;
+        return false;
+    }
+    queue[(head + count) % RANGE_QUEUE_SIZE] = {anchorId, range, round, micros()};
+    ++count;
+    return true;
+}
+
+/**
+ * @brief Choose when the solver runs; ranges recorded so far are solved first.
+ *
+ * @param batchPolicy Per range, per ranging round or at a fixed rate
+ * @param interval Solve period in milliseconds, for BATCH_FIXED_RATE
+ */
+void PositionPipeline::setPolicy(BatchPolicy batchPolicy, unsigned long interval)
+{
+    solveBatch();
+    policy = batchPolicy;
+    intervalMs = interval;
+}
+
+/**
+ * @brief Take the queued ranges through the solver and publish the resulting fixes.
+ *
+ * Only the ranges queued when the call starts are processed, so the radio is
+ * serviced again before any that arrive meanwhile. Also solves a batch whose
+ * round deadline or solve period has passed, so it must be called even when
+ * no range arrived.
+ *
+ * @return int Number of ranges processed
+ */
+int PositionPipeline::process()
+{
+    int pending = count;
+    for (int n = 0; n < pending; ++n)
+    {
+        QueuedRange range = queue[head];
+        head = (head + 1) % RANGE_QUEUE_SIZE;
+        --count;
+
+        unsigned long start = micros();
+        queueWait.add(start - range.receivedUs);
+
+        if (policy == BATCH_PER_RANGE)
+        {
+            // Anchor lookup: a range is only usable with the anchor's coordinates
+            bool known = tracker.anchors().findAnchor(range.anchorId) != nullptr;
+            unsigned long looked = micros();
+            lookup.add(looked - start);
+            if (!known)
+            {
+                ++unknownAnchor;
+                LOG_DEBUG(LOG_MODULE_UWB, "Range from unregistered anchor %04X", range.anchorId);
+                continue;
+            }
+
+            // Solver and Kalman filter
+            TrackingStatus status = tracker.updateRange(range.anchorId, range.range, range.receivedUs);
+            unsigned long solved = micros();
+            solve.add(solved - looked);
+            ++solves;
+            if (status != TRACKING_OK)
+            {
+                ++noFix;
+                continue;
+            }
+            publishFix(range.anchorId, range.receivedUs, solved);
+            continue;
+        }
+
+        // A range that belongs to the next round closes the current one before it overwrites anything
+        bool repeated = inBatch(range.anchorId);
+        if (policy == BATCH_PER_ROUND && batchCount > 0 &&
+            (range.round != AUTO_ROUND ? range.round != batchRound : repeated))
+        {
+            solveBatch();
+            start = micros();
+            repeated = false;
+        }
+
+        // Anchor lookup and storage, without solving
+        TrackingStatus status = tracker.recordRange(range.anchorId, range.range, range.receivedUs);
+        lookup.add(micros() - start);
+        if (status != TRACKING_OK)
+        {
+            ++unknownAnchor;
+            LOG_DEBUG(LOG_MODULE_UWB, "Range from unregistered anchor %04X", range.anchorId);
+            continue;
+        }
+        if (batchCount == 0)
+        {
+            batchStartMs = millis();
+            batchRound = range.round;
+        }
+        batchLastUs = range.receivedUs;
+        if (!repeated)
+        {
+            batchAnchors[batchCount++] = range.anchorId;
+        }
+
+        if (policy == BATCH_PER_ROUND && batchCount >= tracker.anchors().size())
+        {
+            solveBatch(); // Every registered anchor has reported
+        }
+    }
+
+    if (batchCount > 0)
+    {
+        unsigned long now = millis();
+        if ((policy == BATCH_PER_ROUND && now - batchStartMs >= ROUND_DEADLINE_MS) ||
+            (policy == BATCH_FIXED_RATE && now - lastSolveMs >= intervalMs))
+        {
+            solveBatch();
+        }
+    }
+    return pending;
+}
+
+/**
+ * @brief Whether an anchor's range was recorded since the last solve
+ */
+bool PositionPipeline::inBatch(uint16_t anchorId) const
+{
+    for (int i = 0; i < batchCount; ++i)
+    {
+        if (batchAnchors[i] == anchorId)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Solve the recorded ranges as one epoch and publish the fix
+ */
+void PositionPipeline::solveBatch()
+{
+    if (batchCount == 0)
+    {
+        return;
+    }
+    uint16_t lastAnchor = batchAnchors[batchCount - 1];
+    LOG_TRACE(LOG_MODULE_UWB, "Solving %d ranges of round %u", batchCount, batchRound);
+    batchCount = 0;
+    lastSolveMs = millis();
+
+    unsigned long start = micros();
+    TrackingStatus status = tracker.solve();
+    unsigned long solved = micros();
+    solve.add(solved - start);
+    ++solves;
+    if (status != TRACKING_OK)
+    {
+        ++noFix;
+        return;
+    }
+    publishFix(lastAnchor, batchLastUs, solved);
+}
+
+/**
+ * @brief Copy the filter state into the published fix and notify the listener
+ *
+ * @param anchorId Anchor whose range completed the fix
+ * @param rangeUs micros() at the callback of that range
+ * @param solvedUs micros() when the solver returned
+ */
+void PositionPipeline::publishFix(uint16_t anchorId, unsigned long rangeUs, unsigned long solvedUs)
+{
+    tracker.getPosition(fix.position, fix.velocity);
+    // micros() wraps long before millis(), so convert through the range's age
+    fix.timestamp = millis() - (micros() - rangeUs) / 1000;
+    fix.sequence = ++fixes;
+    fix.anchorId = anchorId;
+    if (listener)
+    {
+        listener(fix);
+    }
+    publish.add(micros() - solvedUs);
+    LOG_TRACE(LOG_MODULE_UWB, "Fix %lu: %.2f %.2f %.2f", (unsigned long)fix.sequence, fix.position[0], fix.position[1], fix.position[2]);
+}
+
+/**
+ * @brief Print range counters and per-stage latency
+ */
+void PositionPipeline::printStats() const
+{
+    const char *policyNames[] = {"per range", "per round", "fixed rate"};
+    Serial.printf("Pipeline (%s): %lu ranges, %lu solves, %lu fixes, %lu dropped, %lu unknown anchor, %lu without fix, %d queued\n",
+                  policyNames[policy], (unsigned long)received, (unsigned long)solves, (unsigned long)fixes,
+                  (unsigned long)dropped, (unsigned long)unknownAnchor, (unsigned long)noFix, count);
+    const StageTiming *stages[] = {&queueWait, &lookup, &solve, &publish};
+    const char *names[] = {"queue", "lookup", "solve", "publish"};
+    for (int i = 0; i < 4; ++i)
+    {
+        const StageTiming &stage = *stages[i];
+        Serial.printf("  %-8s mean %lu us, max %lu us (%lu samples)\n", names[i],
+                      (unsigned long)(stage.count ? stage.totalUs / stage.count : 0), (unsigned long)stage.maxUs,
+                      (unsigned long)stage.count);
+    }
+}
+
+/**
+ * @brief Zero the counters and latencies
+ */
+void PositionPipeline::resetStats()
+{
+    received = 0;
+    dropped = 0;
+    unknownAnchor = 0;
+    solves = 0;
+    noFix = 0;
+    queueWait.reset();
+    lookup.reset();
+    solve.reset();
+    publish.reset();
+}
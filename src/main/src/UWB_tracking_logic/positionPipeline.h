@@ -0,0 +1,133 @@
+#ifndef POSITION_PIPELINE_H
+#define POSITION_PIPELINE_H
+
+#include <Arduino.h>
+#include "trilateration.h"
+
+#ifndef RANGE_QUEUE_SIZE
+#define RANGE_QUEUE_SIZE 16 // Ranges buffered between the radio callback and the solver
+#endif
+
+#ifndef ROUND_DEADLINE_MS
+#define ROUND_DEADLINE_MS 20 // An incomplete ranging round is solved this long after its first range
+#endif
+
+#ifndef BATCH_INTERVAL_MS
+#define BATCH_INTERVAL_MS 100 // Default solve period of BATCH_FIXED_RATE
+#endif
+
+/**
+ * @brief When the pipeline solves
+ */
+enum BatchPolicy
+{
+    BATCH_PER_RANGE,  // After every range
+    BATCH_PER_ROUND,  // Once per ranging round, when it completes or ROUND_DEADLINE_MS after it started
+    BATCH_FIXED_RATE, // Every interval, with the latest range of each anchor
+};
+
+/**
+ * @brief A filtered position, as published by the pipeline
+ */
+struct PositionFix
+{
+    float position[3];       // x, y, z (z = 0 in 2D)
+    float velocity[3];       // vx, vy, vz (vz = 0 in 2D)
+    unsigned long timestamp; // millis() of the range that produced it
+    uint32_t sequence;       // Increments with every published fix
+    uint16_t anchorId;       // Anchor whose range triggered it
+};
+
+/**
+ * @brief Latency of one pipeline stage
+ */
+struct StageTiming
+{
+    uint32_t count;
+    uint32_t totalUs;
+    uint32_t maxUs;
+
+    void add(uint32_t us);
+    void reset();
+};
+
+/**
+ * @brief Streams ranges from the UWB radio to a published, filtered position.
+ *
+ * The ranging callback only enqueues (anchor short address, range), so it
+ * returns before the radio's next poll; process() runs from the main loop
+ * after the radio has been serviced and takes each range through anchor
+ * lookup, the solver and Kalman filter, and publication. When ranges arrive
+ * faster than they are solved the queue fills and new ones are counted as
+ * dropped.
+ *
+ * A tag hears all anchors within a few milliseconds of each ranging round, so
+ * by default the ranges of a round are stored and solved once, as one epoch.
+ * A round ends when its ID changes, when every registered anchor has
+ * reported, or ROUND_DEADLINE_MS after its first range. Ranges pushed without
+ * a round ID start a new round when their anchor already reported in the
+ * current one.
+ */
+class PositionPipeline
+{
+public:
+    typedef void (*Listener)(const PositionFix &fix);
+
+    static const uint16_t AUTO_ROUND = 0xFFFF; // Round ID of ranges without one
+
+    explicit PositionPipeline(trilateration &tracker);
+
+    bool pushRange(uint16_t anchorId, float range, uint16_t round = AUTO_ROUND);
+    int process();
+
+    void setPolicy(BatchPolicy batchPolicy, unsigned long interval = BATCH_INTERVAL_MS);
+    BatchPolicy getPolicy() const { return policy; }
+
+    bool hasFix() const { return fixes > 0; }
+    const PositionFix &latest() const { return fix; }
+    void setListener(Listener callback) { listener = callback; }
+
+    void printStats() const;
+    void resetStats();
+
+private:
+    struct QueuedRange
+    {
+        uint16_t anchorId;
+        float range;
+        uint16_t round;
+        unsigned long receivedUs; // micros() at the callback
+    };
+
+    bool inBatch(uint16_t anchorId) const;
+    void solveBatch();
+    void publishFix(uint16_t anchorId, unsigned long rangeUs, unsigned long solvedUs);
+
+    trilateration &tracker;
+    Listener listener;
+
+    BatchPolicy policy;
+    unsigned long intervalMs;           // Solve period of BATCH_FIXED_RATE
+    uint16_t batchAnchors[MAX_ANCHORS]; // Anchors recorded since the last solve
+    int batchCount;
+    uint16_t batchRound;        // Round ID of the recorded ranges
+    unsigned long batchStartMs; // millis() of the first recorded range
+    unsigned long batchLastUs;  // micros() at the callback of the latest recorded range
+    unsigned long lastSolveMs;
+
+    QueuedRange queue[RANGE_QUEUE_SIZE];
+    int head;  // Next range to process
+    int count; // Ranges waiting
+
+    PositionFix fix;
+    uint32_t fixes;
+
+    uint32_t received;      // Ranges handed to pushRange
+    uint32_t dropped;       // Lost to a full queue
+    uint32_t unknownAnchor; // From anchors without registered coordinates
+    uint32_t solves;        // Solver runs, one per range or batch
+    uint32_t noFix;         // Solved without a position (too few anchors, degenerate geometry...)
+    StageTiming queueWait, lookup, solve, publish;
+};
+
+#endif // POSITION_PIPELINE_H
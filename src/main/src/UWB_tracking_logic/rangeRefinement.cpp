@@ -0,0 +1,152 @@
+#include "rangeRefinement.h"
+
+static const float DAMPING_FLOOR = 1e-6f; // Keeps directions the anchors do not constrain solvable
+static const float MIN_DAMPING = 1e-7f;
+static const float MAX_DAMPING = 1e7f;
+static const float COST_RESOLUTION = 1e-6f; // Relative cost change that float arithmetic cannot resolve
+
+/**
+ * @brief Sum of squared range residuals at x, optionally with the Gauss-Newton normal equations
+ *
+ * @param JtJ Optional output, J^T J of the residual Jacobian
+ * @param Jtr Optional output, J^T r
+ */
+template <int Dims>
+static float rangeCost(const DataPoint *points, int count, const float *x,
+                       FixedMatrix<Dims, Dims> *JtJ, FixedMatrix<Dims, 1> *Jtr)
+{
+    if (JtJ)
+    {
+        JtJ->set_value(0);
+        Jtr->set_value(0);
+    }
+
+    float cost = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const float p[3] = {points[i].x, points[i].y, points[i].z};
+        float delta[Dims];
+        float distanceSquared = 0;
+        for (int j = 0; j < Dims; ++j)
+        {
+            delta[j] = x[j] - p[j];
+            distanceSquared += delta[j] * delta[j];
+        }
+        float distance = sqrtf(distanceSquared);
+        float residual = distance - points[i].d;
+        cost += residual * residual;
+
+        // The gradient of |x - p| is undefined on the anchor itself; the row is left out
+        if (JtJ && distance > 0)
+        {
+            for (int j = 0; j < Dims; ++j)
+            {
+                float Jj = delta[j] / distance;
+                for (int k = 0; k <= j; ++k)
+                {
+                    (*JtJ)(j, k) += Jj * delta[k] / distance;
+                }
+                (*Jtr)(j, 0) += Jj * residual;
+            }
+        }
+    }
+    if (JtJ)
+    {
+        for (int j = 0; j < Dims; ++j)
+        {
+            for (int k = j + 1; k < Dims; ++k)
+            {
+                (*JtJ)(j, k) = (*JtJ)(k, j);
+            }
+        }
+    }
+    return cost;
+}
+
+/**
+ * @brief Refine a position by minimizing the range residuals |x - p_i| - d_i.
+ *
+ * Levenberg-Marquardt: Gauss-Newton steps on (J^T J + lambda diag) dx = -J^T r,
+ * with lambda lowered after a step that reduces the cost and raised after one
+ * that does not. Unlike the differenced linear equations, every range enters
+ * with equal weight and no anchor is singled out as the reference.
+ *
+ * From a good start (the filter prediction) it usually stops after one or two
+ * steps; it never takes more than LM_MAX_ITERATIONS.
+ *
+ * @param points Anchors and measured ranges
+ * @param count Number of anchors
+ * @param position In: starting point, out: refined position (Dims coordinates)
+ * @param info Optional diagnostics
+ * @return TrackingStatus TRACKING_OK, or TRACKING_NOT_ENOUGH_POINTS with fewer than Dims anchors
+ */
+template <int Dims>
+TrackingStatus refinePosition(const DataPoint *points, int count, float *position, RefinementInfo *info)
+{
+    if (count < Dims)
+    {
+        return TRACKING_NOT_ENOUGH_POINTS;
+    }
+
+    FixedMatrix<Dims, Dims> JtJ;
+    FixedMatrix<Dims, 1> Jtr;
+    float cost = rangeCost<Dims>(points, count, position, &JtJ, &Jtr);
+    float lambda = LM_INITIAL_DAMPING;
+    bool converged = false;
+    int iteration = 0;
+
+    while (iteration < LM_MAX_ITERATIONS && !converged)
+    {
+        ++iteration;
+
+        FixedMatrix<Dims, Dims> N = JtJ;
+        for (int j = 0; j < Dims; ++j)
+        {
+            N(j, j) += lambda * JtJ(j, j) + DAMPING_FLOOR;
+        }
+        Cholesky<FixedMatrix<Dims, Dims>> cholesky(N);
+        if (!cholesky.success())
+        {
+            break;
+        }
+        FixedMatrix<Dims, 1> step = cholesky.solve(Jtr);
+
+        float trial[Dims];
+        float stepSquared = 0;
+        for (int j = 0; j < Dims; ++j)
+        {
+            trial[j] = position[j] - step(j, 0);
+            stepSquared += step(j, 0) * step(j, 0);
+        }
+        converged = stepSquared < LM_STEP_TOLERANCE * LM_STEP_TOLERANCE;
+
+        float trialCost = rangeCost<Dims>(points, count, trial, nullptr, nullptr);
+        if (trialCost < cost)
+        {
+            for (int j = 0; j < Dims; ++j)
+            {
+                position[j] = trial[j];
+            }
+            lambda = std::max(lambda * 0.1f, MIN_DAMPING);
+            cost = converged ? trialCost : rangeCost<Dims>(points, count, position, &JtJ, &Jtr);
+        }
+        else
+        {
+            // A step that changes the cost by less than float resolution means
+            // the minimum is reached; raising lambda would not help
+            converged = converged || trialCost - cost <= cost * COST_RESOLUTION;
+            lambda = std::min(lambda * 10, MAX_DAMPING);
+        }
+    }
+
+    if (info)
+    {
+        info->iterations = iteration;
+        info->rmsResidual = sqrtf(cost / count);
+        info->converged = converged;
+    }
+    return TRACKING_OK;
+}
+
+template TrackingStatus refinePosition<2>(const DataPoint *, int, float *, RefinementInfo *);
+template TrackingStatus refinePosition<3>(const DataPoint *, int, float *, RefinementInfo *);
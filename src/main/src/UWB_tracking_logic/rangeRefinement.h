@@ -0,0 +1,38 @@
+#ifndef RANGE_REFINEMENT_H
+#define RANGE_REFINEMENT_H
+
+#include "fixedMatrix.h"
+#include "factorization.h"
+#include "anchorRegistry.h"
+#include "status.h"
+
+#ifndef LM_MAX_ITERATIONS
+#define LM_MAX_ITERATIONS 5 // Hard cap on Levenberg-Marquardt steps per fix
+#endif
+
+#ifndef LM_STEP_TOLERANCE
+#define LM_STEP_TOLERANCE 1e-3f // Stop once a step is shorter than this (metres)
+#endif
+
+#ifndef LM_INITIAL_DAMPING
+#define LM_INITIAL_DAMPING 1e-3f // Starting lambda; small, since the start is usually close
+#endif
+
+#ifndef LM_REINIT_RESIDUAL
+#define LM_REINIT_RESIDUAL 0.5f // RMS range residual (metres) above which a warm start is rejected
+#endif
+
+/**
+ * @brief Diagnostics of a refinement
+ */
+struct RefinementInfo
+{
+    int iterations;    // Steps tried, accepted or not
+    float rmsResidual; // sqrt(mean((|x - p_i| - d_i)^2)) at the result
+    bool converged;    // The last step was shorter than LM_STEP_TOLERANCE
+};
+
+template <int Dims>
+TrackingStatus refinePosition(const DataPoint *points, int count, float *position, RefinementInfo *info = nullptr);
+
+#endif // RANGE_REFINEMENT_H
@@ -0,0 +1,253 @@
+#include "robustSolver.h"
+#include <algorithm>
+
+static const uint32_t SAMPLING_SEED = 0x2545F491u; // Fixed, so a given input always gives the same fix
+
+/**
+ * @brief Flag the anchors whose range agrees with a position
+ *
+ * @param inliers Output, one flag per point
+ * @return int Number of inliers
+ */
+template <int Dims>
+int classifyInliers(const DataPoint *points, int count, const float *position, bool *inliers, float threshold)
+{
+    int inlierCount = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const float p[3] = {points[i].x, points[i].y, points[i].z};
+        float distanceSquared = 0;
+        for (int j = 0; j < Dims; ++j)
+        {
+            distanceSquared += (position[j] - p[j]) * (position[j] - p[j]);
+        }
+        inliers[i] = fabsf(sqrtf(distanceSquared) - points[i].d) <= threshold;
+        inlierCount += inliers[i];
+    }
+    return inlierCount;
+}
+
+/**
+ * @brief Truncated squared-residual cost (MSAC): inliers by residual, outliers at the threshold
+ */
+template <int Dims>
+static float consensusCost(const DataPoint *points, int count, const float *position)
+{
+    float cost = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const float p[3] = {points[i].x, points[i].y, points[i].z};
+        float distanceSquared = 0;
+        for (int j = 0; j < Dims; ++j)
+        {
+            distanceSquared += (position[j] - p[j]) * (position[j] - p[j]);
+        }
+        float residual = sqrtf(distanceSquared) - points[i].d;
+        cost += std::min(residual * residual, RANSAC_INLIER_THRESHOLD * RANSAC_INLIER_THRESHOLD);
+    }
+    return cost;
+}
+
+/**
+ * @brief Number of k-subsets of n, capped at limit + 1
+ */
+static int countSubsets(int n, int k, int limit)
+{
+    long subsets = 1;
+    for (int i = 1; i <= k; ++i)
+    {
+        subsets = subsets * (n - k + i) / i;
+        if (subsets > limit)
+        {
+            return limit + 1;
+        }
+    }
+    return subsets;
+}
+
+/**
+ * @brief Advance a sorted k-subset of [0, n) to the next in lexicographic order
+ *
+ * @return false after the last subset
+ */
+static bool nextSubset(int *subset, int k, int n)
+{
+    int i = k - 1;
+    while (i >= 0 && subset[i] == n - k + i)
+    {
+        --i;
+    }
+    if (i < 0)
+    {
+        return false;
+    }
+    ++subset[i];
+    for (int j = i + 1; j < k; ++j)
+    {
+        subset[j] = subset[j - 1] + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Draw k distinct indices of [0, n) with a xorshift generator
+ */
+static void randomSubset(int *subset, int k, int n, uint32_t &state)
+{
+    for (int i = 0; i < k; ++i)
+    {
+        bool repeated;
+        do
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            subset[i] = state % n;
+            repeated = false;
+            for (int j = 0; j < i; ++j)
+            {
+                repeated = repeated || subset[j] == subset[i];
+            }
+        } while (repeated);
+    }
+}
+
+/**
+ * @brief Position fix that tolerates ranges inflated by non-line-of-sight propagation.
+ *
+ * RANSAC over minimal anchor sets: each subset of Dims + 1 anchors is solved
+ * in closed form and scored by the truncated squared residuals of all ranges
+ * (MSAC). The best hypothesis is refined by Levenberg-Marquardt on its
+ * inliers, which are then classified again at the refined position.
+ *
+ * The work is bounded: when there are at most RANSAC_MAX_ITERATIONS subsets
+ * all of them are tried, otherwise that many are drawn from a fixed-seed
+ * generator, and sampling stops early after RANSAC_TIME_BUDGET_US or once a
+ * hypothesis agrees with every range. A subset whose mirror solutions its
+ * own anchors cannot tell apart gives no hypothesis and is skipped.
+ *
+ * @param points Anchors with ranges
+ * @param count Number of anchors
+ * @param position Output, Dims coordinates
+ * @param inliers Output, one flag per point
+ * @param previous Optional previous position, for the mirror ambiguity of the closed form
+ * @param info Optional diagnostics
+ * @return TrackingStatus TRACKING_OK, TRACKING_NOT_ENOUGH_POINTS,
+ *         TRACKING_RANK_DEFICIENT if every subset tried was ambiguous (e.g. coplanar
+ *         anchors in 3D without a previous position), or TRACKING_NO_CONSENSUS if
+ *         fewer than Dims + 1 ranges agree on any position
+ */
+template <int Dims>
+TrackingStatus solveRobust(const DataPoint *points, int count, float *position, bool *inliers,
+                           const float *previous, RobustInfo *info)
+{
+    const int k = Dims + 1;
+    if (count < k)
+    {
+        return TRACKING_NOT_ENOUGH_POINTS;
+    }
+
+    unsigned long start = micros();
+    bool exhaustive = countSubsets(count, k, RANSAC_MAX_ITERATIONS) <= RANSAC_MAX_ITERATIONS;
+    uint32_t state = SAMPLING_SEED;
+    int subset[Dims + 1];
+    for (int i = 0; i < k; ++i)
+    {
+        subset[i] = i;
+    }
+
+    float best[Dims];
+    float bestCost = 0;
+    bool found = false;
+    int iteration = 0;
+    int ambiguous = 0; // Subsets skipped for the mirror ambiguity
+    while (iteration < RANSAC_MAX_ITERATIONS && micros() - start < RANSAC_TIME_BUDGET_US)
+    {
+        if (!exhaustive)
+        {
+            randomSubset(subset, k, count, state);
+        }
+        else if (iteration > 0 && !nextSubset(subset, k, count))
+        {
+            break;
+        }
+        ++iteration;
+
+        DataPoint sample[Dims + 1];
+        for (int i = 0; i < k; ++i)
+        {
+            sample[i] = points[subset[i]];
+        }
+        float candidate[Dims];
+        TrackingStatus status = solveClosedForm<Dims>(sample, k, candidate, previous);
+        if (status != TRACKING_OK)
+        {
+            ambiguous += status == TRACKING_RANK_DEFICIENT;
+            continue;
+        }
+
+        float cost = consensusCost<Dims>(points, count, candidate);
+        if (!found || cost < bestCost)
+        {
+            found = true;
+            bestCost = cost;
+            for (int j = 0; j < Dims; ++j)
+            {
+                best[j] = candidate[j];
+            }
+            if (classifyInliers<Dims>(points, count, best, inliers) == count)
+            {
+                break; // Every range agrees, no subset can do better
+            }
+        }
+    }
+
+    if (info)
+    {
+        info->iterations = iteration;
+        info->inlierCount = 0;
+        info->rmsResidual = 0;
+    }
+    if (!found)
+    {
+        return ambiguous > 0 ? TRACKING_RANK_DEFICIENT : TRACKING_NO_CONSENSUS;
+    }
+    if (classifyInliers<Dims>(points, count, best, inliers) < k)
+    {
+        return TRACKING_NO_CONSENSUS;
+    }
+
+    // Refit on the inliers, then classify again at the refined position
+    DataPoint inlierPoints[MAX_ANCHORS];
+    int inlierCount = 0;
+    for (int i = 0; i < count && inlierCount < MAX_ANCHORS; ++i)
+    {
+        if (inliers[i])
+        {
+            inlierPoints[inlierCount++] = points[i];
+        }
+    }
+    RefinementInfo refinement;
+    refinePosition<Dims>(inlierPoints, inlierCount, best, &refinement);
+    inlierCount = classifyInliers<Dims>(points, count, best, inliers);
+    if (inlierCount < k)
+    {
+        return TRACKING_NO_CONSENSUS;
+    }
+
+    for (int j = 0; j < Dims; ++j)
+    {
+        position[j] = best[j];
+    }
+    if (info)
+    {
+        info->inlierCount = inlierCount;
+        info->rmsResidual = refinement.rmsResidual;
+    }
+    return TRACKING_OK;
+}
+
+template int classifyInliers<2>(const DataPoint *, int, const float *, bool *, float);
+template int classifyInliers<3>(const DataPoint *, int, const float *, bool *, float);
+template TrackingStatus solveRobust<2>(const DataPoint *, int, float *, bool *, const float *, RobustInfo *);
+template TrackingStatus solveRobust<3>(const DataPoint *, int, float *, bool *, const float *, RobustInfo *);
@@ -0,0 +1,39 @@
+#ifndef ROBUST_SOLVER_H
+#define ROBUST_SOLVER_H
+
+#include "anchorRegistry.h"
+#include "closedFormSolver.h"
+#include "rangeRefinement.h"
+#include "status.h"
+
+#ifndef RANSAC_MAX_ITERATIONS
+#define RANSAC_MAX_ITERATIONS 32 // Minimal subsets tried per fix at most
+#endif
+
+#ifndef RANSAC_TIME_BUDGET_US
+#define RANSAC_TIME_BUDGET_US 2000 // Stop sampling after this many microseconds
+#endif
+
+#ifndef RANSAC_INLIER_THRESHOLD
+#define RANSAC_INLIER_THRESHOLD 0.3f // Range residual (metres) up to which an anchor agrees with a position
+#endif
+
+/**
+ * @brief Diagnostics of a robust fix
+ */
+struct RobustInfo
+{
+    int iterations;    // Minimal subsets tried
+    int inlierCount;   // Anchors that agree with the final position
+    float rmsResidual; // RMS range residual of the inliers at the final position
+};
+
+template <int Dims>
+int classifyInliers(const DataPoint *points, int count, const float *position, bool *inliers,
+                    float threshold = RANSAC_INLIER_THRESHOLD);
+
+template <int Dims>
+TrackingStatus solveRobust(const DataPoint *points, int count, float *position, bool *inliers,
+                           const float *previous = nullptr, RobustInfo *info = nullptr);
+
+#endif // ROBUST_SOLVER_H
@@ -0,0 +1,61 @@
+#include "status.h"
+
+static TrackingStatus pendingError = TRACKING_OK;
+
+/**
+ * @brief Human-readable name of a status code
+ */
+const char *trackingStatusString(TrackingStatus status)
+{
+    switch (status)
+    {
+    case TRACKING_OK:
+        return "ok";
+    case TRACKING_EMPTY_INPUT:
+        return "empty input";
+    case TRACKING_DIMENSION_MISMATCH:
+        return "dimension mismatch";
+    case TRACKING_INDEX_OUT_OF_RANGE:
+        return "index out of range";
+    case TRACKING_SINGULAR:
+        return "singular matrix";
+    case TRACKING_UNDERDETERMINED:
+        return "more unknowns than equations";
+    case TRACKING_RANK_DEFICIENT:
+        return "rank deficient";
+    case TRACKING_NOT_ENOUGH_POINTS:
+        return "not enough points";
+    case TRACKING_COLLINEAR:
+        return "collinear anchors";
+    case TRACKING_UNKNOWN_ANCHOR:
+        return "unknown anchor";
+    case TRACKING_NO_CONSENSUS:
+        return "no consensus";
+    case TRACKING_OUTLIER:
+        return "outlier";
+    case TRACKING_STALE:
+        return "stale";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Record a failure; the first one is kept until it is taken
+ */
+void reportTrackingError(TrackingStatus status)
+{
+    if (pendingError == TRACKING_OK)
+    {
+        pendingError = status;
+    }
+}
+
+/**
+ * @brief Return the first failure reported since the last call and clear it
+ */
+TrackingStatus takeTrackingError()
+{
+    TrackingStatus status = pendingError;
+    pendingError = TRACKING_OK;
+    return status;
+}
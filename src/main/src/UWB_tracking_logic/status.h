@@ -0,0 +1,69 @@
+#ifndef TRACKING_STATUS_H
+#define TRACKING_STATUS_H
+
+#include "utils/log.h"
+
+/**
+ * @brief Outcome of a tracking-math operation.
+ */
+enum TrackingStatus
+{
+    TRACKING_OK = 0,
+    TRACKING_EMPTY_INPUT,        // Matrix or point set without elements
+    TRACKING_DIMENSION_MISMATCH, // Operand sizes do not fit together
+    TRACKING_INDEX_OUT_OF_RANGE, // Row, column or block outside the matrix
+    TRACKING_SINGULAR,           // Matrix is not invertible
+    TRACKING_UNDERDETERMINED,    // Fewer equations than unknowns
+    TRACKING_RANK_DEFICIENT,     // Anchor geometry does not determine the position
+    TRACKING_NOT_ENOUGH_POINTS,  // Too few ranges buffered for a fix
+    TRACKING_COLLINEAR,          // Anchors lie on a line
+    TRACKING_UNKNOWN_ANCHOR,     // Range from an anchor that is not registered
+    TRACKING_NO_CONSENSUS,       // Too few ranges agree on a position
+    TRACKING_OUTLIER,            // Range too far from the filter's prediction
+    TRACKING_STALE               // Measurement older than the filter's history
+};
+
+const char *trackingStatusString(TrackingStatus status);
+
+/**
+ * Operators and other functions that return a Matrix cannot return a status,
+ * so they report the first failure here (like errno) and return a zero matrix.
+ */
+void reportTrackingError(TrackingStatus status);
+TrackingStatus takeTrackingError();
+
+// Report a status and log the details at DEBUG level in the math module
+#define TRACKING_ERROR(status, fmt, ...)                          \
+    do                                                            \
+    {                                                             \
+        reportTrackingError(status);                              \
+        LOG_DEBUG(LOG_MODULE_MATH, fmt, ##__VA_ARGS__);           \
+    } while (0)
+
+/**
+ * @brief A value or the status explaining why there is none.
+ *
+ * @tparam T Result type, must be default constructible
+ */
+template <typename T>
+class Expected
+{
+public:
+    Expected(const T &value) : result(value), code(TRACKING_OK) {}
+    Expected(TrackingStatus status) : result(), code(status) {}
+
+    bool ok() const { return code == TRACKING_OK; }
+    explicit operator bool() const { return ok(); }
+    TrackingStatus status() const { return code; }
+
+    T &value() { return result; }
+    const T &value() const { return result; }
+    T &operator*() { return result; }
+    const T &operator*() const { return result; }
+
+private:
+    T result;
+    TrackingStatus code;
+};
+
+#endif // TRACKING_STATUS_H
@@ -0,0 +1,367 @@
+#include "trackerPool.h"
+#include <new>
+
+/**
+ * @brief Create an empty pool; all trackers are allocated here, none later.
+ */
+template <int Dims>
+TrackerPool<Dims>::TrackerPool()
+    : mostRecent(-1), leastRecent(-1), firstFree(0), count(0), evictions(0), queueHead(0), queueCount(0), dropped(0),
+      selector(site)
+{
+    for (int slot = 0; slot < TRACKER_POOL_SIZE; ++slot)
+    {
+        next[slot] = slot + 1 < TRACKER_POOL_SIZE ? slot + 1 : -1;
+    }
+    for (int i = 0; i < TRACKER_POOL_HASH_SIZE; ++i)
+    {
+        table[i] = -1;
+    }
+}
+
+/**
+ * @brief Preferred table index of a tag (Fibonacci hashing)
+ */
+template <int Dims>
+int TrackerPool<Dims>::home(uint16_t tagId) const
+{
+    return ((tagId * 2654435761u) >> 16) & (TRACKER_POOL_HASH_SIZE - 1);
+}
+
+/**
+ * @brief Table index holding a tag, or -1
+ */
+template <int Dims>
+int TrackerPool<Dims>::lookup(uint16_t tagId) const
+{
+    for (int i = home(tagId);; i = (i + 1) & (TRACKER_POOL_HASH_SIZE - 1))
+    {
+        if (table[i] < 0)
+        {
+            return -1;
+        }
+        if (tags[table[i]] == tagId)
+        {
+            return i;
+        }
+    }
+}
+
+/**
+ * @brief Empty a table index, shifting back later entries of the probe run
+ */
+template <int Dims>
+void TrackerPool<Dims>::erase(int tableIndex)
+{
+    const int mask = TRACKER_POOL_HASH_SIZE - 1;
+    int hole = tableIndex;
+    table[hole] = -1;
+    for (int i = (hole + 1) & mask; table[i] >= 0; i = (i + 1) & mask)
+    {
+        // An entry can fill the hole unless its home lies cyclically in (hole, i]
+        int preferred = home(tags[table[i]]);
+        bool stays = hole <= i ? (hole < preferred && preferred <= i) : (hole < preferred || preferred <= i);
+        if (!stays)
+        {
+            table[hole] = table[i];
+            table[i] = -1;
+            hole = i;
+        }
+    }
+}
+
+/**
+ * @brief Take a slot out of the LRU list
+ */
+template <int Dims>
+void TrackerPool<Dims>::unlink(int slot)
+{
+    if (previous[slot] >= 0)
+        next[previous[slot]] = next[slot];
+    else
+        mostRecent = next[slot];
+    if (next[slot] >= 0)
+        previous[next[slot]] = previous[slot];
+    else
+        leastRecent = previous[slot];
+}
+
+/**
+ * @brief Make a slot the most recently used
+ */
+template <int Dims>
+void TrackerPool<Dims>::pushFront(int slot)
+{
+    previous[slot] = -1;
+    next[slot] = mostRecent;
+    if (mostRecent >= 0)
+        previous[mostRecent] = slot;
+    else
+        leastRecent = slot;
+    mostRecent = slot;
+}
+
+/**
+ * @brief Make a slot the first to be reused
+ */
+template <int Dims>
+void TrackerPool<Dims>::pushBack(int slot)
+{
+    next[slot] = -1;
+    previous[slot] = leastRecent;
+    if (leastRecent >= 0)
+        next[leastRecent] = slot;
+    else
+        mostRecent = slot;
+    leastRecent = slot;
+}
+
+/**
+ * @brief Find the tracker of a tag
+ *
+ * @return Trilateration<Dims>* The tracker, or nullptr if the tag is not tracked
+ */
+template <int Dims>
+Trilateration<Dims> *TrackerPool<Dims>::find(uint16_t tagId)
+{
+    int i = lookup(tagId);
+    return i < 0 ? nullptr : &trackers[table[i]];
+}
+
+/**
+ * @brief Find the tracker of a tag, or start one.
+ *
+ * A new tag takes a free slot, or the slot of the least recently used tag
+ * when the pool is full. The tracker is reinitialized in place, with no
+ * anchors until it ranges to them.
+ *
+ * @param tagId Short address of the tag
+ * @return Trilateration<Dims>* The tag's tracker, now the most recently used
+ */
+template <int Dims>
+Trilateration<Dims> *TrackerPool<Dims>::acquire(uint16_t tagId)
+{
+    int i = lookup(tagId);
+    if (i >= 0)
+    {
+        int slot = table[i];
+        unlink(slot);
+        pushFront(slot);
+        return &trackers[slot];
+    }
+
+    int slot;
+    if (firstFree >= 0)
+    {
+        slot = firstFree;
+        firstFree = next[slot];
+        ++count;
+    }
+    else
+    {
+        slot = leastRecent;
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Tracker pool full, tag %04X replaces %04X", tagId, tags[slot]);
+        erase(lookup(tags[slot]));
+        unlink(slot);
+        ++evictions;
+    }
+
+    tags[slot] = tagId;
+    for (i = home(tagId); table[i] >= 0; i = (i + 1) & (TRACKER_POOL_HASH_SIZE - 1))
+    {
+    }
+    table[i] = slot;
+    pushFront(slot);
+
+    // Start from a clean tracker without a temporary copy on the stack
+    trackers[slot].~Trilateration<Dims>();
+    new (&trackers[slot]) Trilateration<Dims>(&selector);
+    return &trackers[slot];
+}
+
+/**
+ * @brief Feed the range between a tag and an anchor to the tag's tracker
+ *
+ * @param tagId Short address of the tag
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance
+ * @return TrackingStatus TRACKING_OK if the tag's filter was updated, otherwise why not
+ */
+template <int Dims>
+TrackingStatus TrackerPool<Dims>::updateRange(uint16_t tagId, uint16_t anchorId, float distance)
+{
+    return updateRange(tagId, anchorId, distance, micros());
+}
+
+/**
+ * @brief Feed a timestamped range between a tag and an anchor to the tag's tracker
+ *
+ * @param tagId Short address of the tag
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance
+ * @param timestampUs micros() when the range was measured
+ * @return TrackingStatus TRACKING_OK if the tag's filter was updated, otherwise why not
+ */
+template <int Dims>
+TrackingStatus TrackerPool<Dims>::updateRange(uint16_t tagId, uint16_t anchorId, float distance,
+                                              unsigned long timestampUs)
+{
+    const AnchorEntry *anchor = site.findAnchor(anchorId);
+    if (!anchor)
+    {
+        return TRACKING_UNKNOWN_ANCHOR;
+    }
+    Trilateration<Dims> *tracker = acquire(tagId);
+    if (!tracker->anchors().findAnchor(anchorId))
+    {
+        // Into the tracker's window, in place of the anchor with the oldest range when full
+        tracker->anchors().setAnchor(anchorId, anchor->x, anchor->y, anchor->z);
+    }
+    return tracker->updateRange(anchorId, distance, timestampUs);
+}
+
+/**
+ * @brief Queue a range between a tag and an anchor; cheap enough for the ranging callback.
+ *
+ * @param tagId Short address of the tag
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance
+ * @return true if queued, false if the queue was full and the range dropped
+ */
+template <int Dims>
+bool TrackerPool<Dims>::pushRange(uint16_t tagId, uint16_t anchorId, float distance)
+{
+    if (queueCount == TRACKER_POOL_QUEUE_SIZE)
+    {
+        ++dropped;
+        return false;
+    }
+    queue[(queueHead + queueCount) % TRACKER_POOL_QUEUE_SIZE] = {tagId, anchorId, distance, micros()};
+    ++queueCount;
+    return true;
+}
+
+/**
+ * @brief Feed the queued ranges to the trackers of their tags.
+ *
+ * Only the ranges queued when the call starts are processed, so the radio is
+ * serviced again before any that arrive meanwhile.
+ *
+ * @return int Number of ranges processed
+ */
+template <int Dims>
+int TrackerPool<Dims>::process()
+{
+    int pending = queueCount;
+    for (int n = 0; n < pending; ++n)
+    {
+        QueuedRange range = queue[queueHead];
+        queueHead = (queueHead + 1) % TRACKER_POOL_QUEUE_SIZE;
+        --queueCount;
+        if (updateRange(range.tagId, range.anchorId, range.range, range.receivedUs) == TRACKING_UNKNOWN_ANCHOR)
+        {
+            LOG_DEBUG(LOG_MODULE_UWB, "Range from tag %04X to unregistered anchor %04X", range.tagId, range.anchorId);
+        }
+    }
+    return pending;
+}
+
+/**
+ * @brief Queue a tag that went silent for reuse before any active one
+ */
+template <int Dims>
+void TrackerPool<Dims>::markInactive(uint16_t tagId)
+{
+    int i = lookup(tagId);
+    if (i >= 0)
+    {
+        unlink(table[i]);
+        pushBack(table[i]);
+    }
+}
+
+/**
+ * @brief Stop tracking a tag and free its slot
+ *
+ * @return true if the tag was tracked
+ */
+template <int Dims>
+bool TrackerPool<Dims>::release(uint16_t tagId)
+{
+    int i = lookup(tagId);
+    if (i < 0)
+    {
+        return false;
+    }
+    int slot = table[i];
+    erase(i);
+    unlink(slot);
+    next[slot] = firstFree;
+    firstFree = slot;
+    --count;
+    return true;
+}
+
+/**
+ * @brief Register or move an anchor for every tag; trackers that hold it see it move
+ *
+ * @return true if the anchor was added or moved
+ */
+template <int Dims>
+bool TrackerPool<Dims>::setAnchor(uint16_t id, float x, float y, float z)
+{
+    if (!site.setAnchor(id, x, y, z))
+    {
+        return false;
+    }
+    for (int slot = mostRecent; slot >= 0; slot = next[slot])
+    {
+        if (trackers[slot].anchors().findAnchor(id))
+        {
+            trackers[slot].anchors().setAnchor(id, x, y, z);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Remove an anchor for every tag
+ *
+ * @return true if the anchor was registered
+ */
+template <int Dims>
+bool TrackerPool<Dims>::removeAnchor(uint16_t id)
+{
+    if (!site.removeAnchor(id))
+    {
+        return false;
+    }
+    for (int slot = mostRecent; slot >= 0; slot = next[slot])
+    {
+        trackers[slot].anchors().removeAnchor(id);
+    }
+    return true;
+}
+
+/**
+ * @brief Print the tracked tags, most recently ranged first
+ */
+template <int Dims>
+void TrackerPool<Dims>::print() const
+{
+    Serial.printf("Tags: %d / %d, %d / %d anchors, %lu evictions, %lu ranges dropped\n", count, TRACKER_POOL_SIZE, site.size(),
+                  site.capacity(), (unsigned long)evictions, (unsigned long)dropped);
+    for (int slot = mostRecent; slot >= 0; slot = next[slot])
+    {
+        typename TrackerFilter<Dims>::StateVector state = trackers[slot].getState();
+        Serial.printf("Tag %04X:", tags[slot]);
+        for (int j = 0; j < Dims; ++j)
+        {
+            Serial.printf(" %.2f", state(j, 0));
+        }
+        Serial.println();
+    }
+}
+
+template class TrackerPool<2>;
+template class TrackerPool<3>;
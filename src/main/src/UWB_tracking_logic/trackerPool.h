@@ -0,0 +1,96 @@
+#ifndef TRACKER_POOL_H
+#define TRACKER_POOL_H
+
+#include <Arduino.h>
+#include "trilateration.h"
+
+#ifndef TRACKER_POOL_SIZE
+#define TRACKER_POOL_SIZE 8 // Tags tracked at once
+#endif
+
+#ifndef TRACKER_POOL_QUEUE_SIZE
+#define TRACKER_POOL_QUEUE_SIZE 16 // Tag ranges buffered between the radio callback and the trackers
+#endif
+
+#ifndef TRACKER_POOL_HASH_SIZE
+#define TRACKER_POOL_HASH_SIZE 16 // Slots of the short address table, a power of two >= 2 * TRACKER_POOL_SIZE
+#endif
+
+/**
+ * @brief Fixed set of trackers, one per tag, keyed by the tag's short address.
+ *
+ * Every tracker (anchor window, solver and Kalman filter) is allocated with
+ * the pool, so following a fleet never touches the heap. Tags are found
+ * through an open-addressing table in O(1); when all trackers are taken, a
+ * new tag reuses the one of the least recently ranged tag. Tags the radio
+ * reports inactive go to the end of that queue, so they are reused first.
+ *
+ * The ranging callback only queues (tag, anchor, range) with pushRange();
+ * process() feeds the queue to the trackers from the main loop, so no solve
+ * runs inside the radio's interrupt-driven callback.
+ *
+ * Anchors are registered with the pool once, up to SITE_MAX_ANCHORS. A
+ * tracker holds only the MAX_ANCHORS it ranged to most recently: an anchor is
+ * copied into it with its first range, replacing the one with the oldest
+ * range when the window is full. The trackers share one anchor selector,
+ * built over the pool's anchors.
+ *
+ * @tparam Dims Number of dimensions (2 for 2D, 3 for 3D)
+ */
+template <int Dims>
+class TrackerPool
+{
+public:
+    TrackerPool();
+
+    Trilateration<Dims> *find(uint16_t tagId);
+    Trilateration<Dims> *acquire(uint16_t tagId);
+    TrackingStatus updateRange(uint16_t tagId, uint16_t anchorId, float distance);
+    TrackingStatus updateRange(uint16_t tagId, uint16_t anchorId, float distance, unsigned long timestampUs);
+    bool pushRange(uint16_t tagId, uint16_t anchorId, float distance);
+    int process();
+    void markInactive(uint16_t tagId);
+    bool release(uint16_t tagId);
+
+    bool setAnchor(uint16_t id, float x, float y, float z);
+    bool removeAnchor(uint16_t id);
+
+    int size() const { return count; }
+    int capacity() const { return TRACKER_POOL_SIZE; }
+    void print() const;
+
+private:
+    struct QueuedRange
+    {
+        uint16_t tagId;
+        uint16_t anchorId;
+        float range;
+        unsigned long receivedUs; // micros() at the callback
+    };
+
+    int home(uint16_t tagId) const;
+    int lookup(uint16_t tagId) const;
+    void unlink(int slot);
+    void pushFront(int slot);
+    void pushBack(int slot);
+    void erase(int tableIndex);
+
+    Trilateration<Dims> trackers[TRACKER_POOL_SIZE];
+    uint16_t tags[TRACKER_POOL_SIZE];    // Short address of the tag in each slot
+    int8_t previous[TRACKER_POOL_SIZE];  // LRU list, towards the most recent
+    int8_t next[TRACKER_POOL_SIZE];      // LRU list, towards the least recent; free list when unused
+    int8_t mostRecent, leastRecent, firstFree;
+    int8_t table[TRACKER_POOL_HASH_SIZE]; // Slot of each tag, -1 if empty
+    int count;
+    uint32_t evictions;
+
+    QueuedRange queue[TRACKER_POOL_QUEUE_SIZE];
+    int queueHead;    // Next range to process
+    int queueCount;   // Ranges waiting
+    uint32_t dropped; // Ranges lost to a full queue
+
+    AnchorTable<SITE_MAX_ANCHORS> site; // Every registered anchor
+    AnchorSelector<Dims> selector;      // Best-GDOP subsets of site, shared by the trackers
+};
+
+#endif // TRACKER_POOL_H
@@ -1,157 +1,668 @@
 #include "trilateration.h"
+#include <algorithm>
 
 /**
  * @brief Initialize the trilateration algorithm.
  *
- * @param numOfDimensions The number of dimensions (2D or 3D)
+ * @param selector Anchor selector of the site, or nullptr to use every fresh anchor
  */
-trilateration::trilateration(int numOfDimensions)
-    : numOfDimensions(numOfDimensions)
+template <int Dims>
+Trilateration<Dims>::Trilateration(AnchorSelector<Dims> *selector)
+    : selector(selector), robust(true), tightlyCoupled(false), rejectedRanges(0), hasFix(false), lastFixMs(0),
+      latestRangeUs(0), filterUs(0), historyStart(0), historyCount(0), lateMeasurements(0)
 {
-    // Initialize the Kalman filter with the specified number of dimensions
-    kf = KalmanFilter(numOfDimensions);
-
-    // Initialize the buffer index and count
-    bufferIndex = 0;
-    count = 0;
 }
 
 /**
  * @brief Update the trilateration algorithm with a new data point.
  *
+ * The anchor is identified by its coordinates; a repeated report from the same
+ * anchor replaces its previous range.
+ *
  * @param point The new data point (x, y, z, d)
+ * @return TrackingStatus TRACKING_OK if the filter was updated, otherwise why not
+ */
+template <int Dims>
+TrackingStatus Trilateration<Dims>::update(const DataPoint &point)
+{
+    uint16_t id;
+    registry.addRange(point, millis(), &id);
+    incremental.setRange(*registry.findAnchor(id));
+    latestRangeUs = micros();
+    return solve();
+}
+
+/**
+ * @brief Update the trilateration algorithm with a range measured now.
+ *
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance to the anchor
+ * @return TrackingStatus TRACKING_OK if the filter was updated, otherwise why not
  */
-void trilateration::update(const DataPoint &point)
+template <int Dims>
+TrackingStatus Trilateration<Dims>::updateRange(uint16_t anchorId, float distance)
 {
-    // Store the data point in the buffer
-    buffer[bufferIndex] = point;
-    bufferIndex = (bufferIndex + 1) % BUFFER_SIZE;
-    if (count < BUFFER_SIZE)
-        count++;
+    return updateRange(anchorId, distance, micros());
+}
 
-    // Check if we have enough points to compute the least squares solution
-    if (count < (numOfDimensions + 1)) // At least numOfDimensions + 1 points are needed
+/**
+ * @brief Update the trilateration algorithm with a range to a registered anchor.
+ *
+ * In tightly coupled mode, once the filter has a fix, the range goes straight
+ * to the filter as a scalar measurement; otherwise a fix is solved from all
+ * fresh ranges.
+ *
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance to the anchor
+ * @param timestampUs micros() when the range was measured; earlier than previous ranges if it arrived late
+ * @return TrackingStatus TRACKING_OK if the filter was updated, otherwise why not
+ */
+template <int Dims>
+TrackingStatus Trilateration<Dims>::updateRange(uint16_t anchorId, float distance, unsigned long timestampUs)
+{
+    TrackingStatus status = recordRange(anchorId, distance, timestampUs);
+    if (status != TRACKING_OK)
     {
-        Serial.println("Not enough points to compute the least squares solution.");
-        return;
+        return status;
+    }
+    if (tightlyCoupled && hasFix && millis() - lastFixMs <= registry.maxAge())
+    {
+        return updateFilterRange(*registry.findAnchor(anchorId), distance, timestampUs);
     }
+    return solve();
+}
 
-    // Create matrices for the anchor points and distances
-    Matrix cords(count, numOfDimensions);
-    Matrix distances(count, 1);
+/**
+ * @brief Store a range measured now without solving.
+ *
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance to the anchor
+ * @return TrackingStatus TRACKING_OK, or TRACKING_UNKNOWN_ANCHOR
+ */
+template <int Dims>
+TrackingStatus Trilateration<Dims>::recordRange(uint16_t anchorId, float distance)
+{
+    return recordRange(anchorId, distance, micros());
+}
 
-    // Copy the data points to the matrices
-    for (int i = 0; i < count; ++i)
+/**
+ * @brief Store a range to a registered anchor without solving.
+ *
+ * Ranges of one ranging round are recorded this way and solved together by a
+ * single call to solve().
+ *
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance to the anchor
+ * @param timestampUs micros() when the range was measured
+ * @return TrackingStatus TRACKING_OK, or TRACKING_UNKNOWN_ANCHOR
+ */
+template <int Dims>
+TrackingStatus Trilateration<Dims>::recordRange(uint16_t anchorId, float distance, unsigned long timestampUs)
+{
+    if (!registry.addRange(anchorId, distance, millis()))
+    {
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Range from unknown anchor %04X ignored.", anchorId);
+        return TRACKING_UNKNOWN_ANCHOR;
+    }
+    incremental.setRange(*registry.findAnchor(anchorId));
+
+    // A fix is timed by its newest range
+    if (!hasFix || (long)(timestampUs - latestRangeUs) > 0)
+    {
+        latestRangeUs = timestampUs;
+    }
+    return TRACKING_OK;
+}
+
+/**
+ * @brief Compute a fix from the fresh anchors and feed it to the Kalman filter.
+ *
+ * The fix minimizes the range residuals directly, starting from the filter's
+ * prediction. The linear solution is only needed to start the first fix, or
+ * again when the filter lost track (no recent fix, or refinement from the
+ * prediction did not converge to consistent ranges).
+ *
+ * @return TrackingStatus TRACKING_OK if the filter was updated, otherwise why not
+ */
+template <int Dims>
+TrackingStatus Trilateration<Dims>::solve()
+{
+    unsigned long now = millis();
+    registry.expire(now);
+    incremental.expire(registry, now);
+
+    // One row per anchor with a fresh range
+    DataPoint points[MAX_ANCHORS];
+    uint16_t ids[MAX_ANCHORS];
+    int count = registry.collect(points, MAX_ANCHORS, now, ids);
+    if (count < Dims + 1) // At least Dims + 1 points are needed
     {
-        for (int j = 0; j < numOfDimensions; ++j)
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Not enough points to compute the least squares solution.");
+        return TRACKING_NOT_ENOUGH_POINTS;
+    }
+
+    float position[Dims];
+    float predicted[Dims];
+    bool inliers[MAX_ANCHORS];
+    RefinementInfo refinement;
+    bool hasPrediction = hasFix && now - lastFixMs <= registry.maxAge();
+    if (hasPrediction)
+    {
+        predictPosition(latestRangeUs, predicted);
+
+        // On large sites only the anchors with the best geometry around the estimate are used
+        float gdop;
+        int selected = selector ? selector->select(predicted, points, ids, count, &gdop) : count;
+        if (selected < count)
         {
-            cords[i][j] = (j == 0) ? buffer[i].x : (j == 1) ? buffer[i].y
-                                                            : buffer[i].z;
+            LOG_DEBUG(LOG_MODULE_TRILATERATION, "Using %d of %d anchors, GDOP: %.2f", selected, count, gdop);
+            count = selected;
         }
-        distances[i][0] = buffer[i].d;
+
+        std::copy(predicted, predicted + Dims, position);
+        refinePosition<Dims>(points, count, position, &refinement);
+        bool consistent = refinement.rmsResidual < LM_REINIT_RESIDUAL &&
+                          (!robust || classifyInliers<Dims>(points, count, position, inliers) == count);
+        if (refinement.converged && consistent)
+        {
+            LOG_DEBUG(LOG_MODULE_TRILATERATION, "Refined from prediction in %d steps, RMS residual: %.3f", refinement.iterations, refinement.rmsResidual);
+            markInliers(ids, nullptr, count);
+            updateFilter(position, now);
+            return TRACKING_OK;
+        }
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Prediction rejected (RMS residual %.3f), reinitializing.", refinement.rmsResidual);
     }
 
-    // Check if the points are collinear (2D) or coplanar (3D)
-    if (isCollinear(cords))
+    // With redundant anchors, a range inflated by NLOS is voted out. Without
+    // a consensus, e.g. coplanar anchors before the first fix, where every
+    // minimal subset is ambiguous, the least-squares fix below still applies.
+    if (robust && count > Dims + 1)
     {
-        Serial.println("Warning: The points are collinear. Ignoring the update.");
-        return;
+        RobustInfo robustInfo;
+        TrackingStatus status = solveRobust<Dims>(points, count, position, inliers, hasPrediction ? predicted : nullptr, &robustInfo);
+        if (status == TRACKING_OK)
+        {
+            LOG_DEBUG(LOG_MODULE_TRILATERATION, "RANSAC: %d of %d anchors agree after %d subsets, RMS residual: %.3f",
+                      robustInfo.inlierCount, count, robustInfo.iterations, robustInfo.rmsResidual);
+            markInliers(ids, inliers, count);
+            updateFilter(position, now);
+            return TRACKING_OK;
+        }
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Robust fix from %d anchors failed (%s), using least squares.", count, trackingStatusString(status));
     }
-    else if (numOfDimensions == 3 && isCoplanar(cords))
+
+    TrackingStatus status = solveLinear(points, count, now, position);
+    if (status != TRACKING_OK)
     {
-        Serial.println("Warning: The points are coplanar. Assuming target is on the plane.");
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "No fix from %d anchors (%s).", count, trackingStatusString(status));
+        return status;
     }
+    refinePosition<Dims>(points, count, position, &refinement);
+    LOG_DEBUG(LOG_MODULE_TRILATERATION, "Refined from linear solution in %d steps, RMS residual: %.3f", refinement.iterations, refinement.rmsResidual);
 
-    // Compute the centroid of the anchor points
-    Matrix centroid = computeCentroid(cords);
-    Serial.println("Centroid:");
-    centroid.print();
+    markInliers(ids, nullptr, count);
+    updateFilter(position, now);
+    return TRACKING_OK;
+}
 
-    // Center the coordinates
-    Matrix centeredCords(cords.matrix);
-    for (int i = 0; i < cords.rows(); ++i)
+/**
+ * @brief Position without a starting point, used to start the refinement.
+ *
+ * Exactly Dims + 1 anchors are solved in closed form. Otherwise the
+ * incrementally updated normal equations give it in constant time;
+ * degenerate geometry (e.g. coplanar anchors in 3D) falls back to the
+ * differenced system with cached geometry, which handles it.
+ *
+ * @param points Anchors with fresh ranges
+ * @param count Number of anchors
+ * @param now Current time in milliseconds
+ * @param position Output, Dims coordinates
+ * @return TrackingStatus TRACKING_OK, or why there is no solution
+ */
+template <int Dims>
+TrackingStatus Trilateration<Dims>::solveLinear(const DataPoint *points, int count, unsigned long now, float *position)
+{
+    // The minimal anchor set has a closed-form solution; the previous fix picks between its mirror images
+    if (count == Dims + 1)
     {
-        for (int j = 0; j < cords.cols(); ++j)
+        float previous[Dims];
+        if (hasFix)
+        {
+            predictPosition(latestRangeUs, previous);
+        }
+        TrackingStatus status = solveClosedForm<Dims>(points, count, position, hasFix ? previous : nullptr);
+        if (status == TRACKING_OK)
         {
-            centeredCords[i][j] -= centroid[0][j];
+            LOG_DEBUG(LOG_MODULE_TRILATERATION, "Closed-form fix from %d anchors", count);
+            return TRACKING_OK;
         }
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Closed-form fix failed (%s).", trackingStatusString(status));
     }
-    Serial.println("Centered Cords:");
-    centeredCords.print();
 
-    // Compute the SVD of the centered coordinates
-    std::tuple<Matrix, Matrix, Matrix> svdResult = svd(centeredCords);
-    Matrix U = std::get<0>(svdResult);
-    Matrix Sigma = std::get<1>(svdResult);
-    Matrix V = std::get<2>(svdResult);
-    Serial.println("U:");
-    U.print();
-    Serial.println("Sigma:");
-    Sigma.print();
-    Serial.println("V:");
-    V.print();
+    if (incremental.needsRebuild())
+    {
+        incremental.rebuild(registry, now);
+    }
+
+    float condition;
+    if (incremental.solve(position, &condition) == TRACKING_OK)
+    {
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Incremental LS from %d anchors, condition estimate: %.1f", incremental.size(), condition);
+        return TRACKING_OK;
+    }
+    return geometry.solve(points, count, position);
+}
 
-    // Compute the linear equations
-    std::pair<Matrix, Matrix> equations = computeEquations(centeredCords, distances);
+/**
+ * @brief Position the filter expects at a time, extrapolated from its state.
+ *
+ * @param timeUs micros() timestamp
+ * @param position Output, Dims coordinates
+ */
+template <int Dims>
+void Trilateration<Dims>::predictPosition(unsigned long timeUs, float *position) const
+{
+    typename TrackerFilter<Dims>::StateVector state = kf.getState();
+    float dt = (long)(timeUs - filterUs) / 1e6f;
+    for (int j = 0; j < Dims; ++j)
+    {
+        position[j] = state(j, 0) + state(j + Dims, 0) * dt;
+    }
+}
 
-    // Handle coplanar points in 3D
-    if (numOfDimensions == 3 && isCoplanar(Sigma))
+/**
+ * @brief Record in the registry which ranges agreed with the fix
+ *
+ * @param ids Anchor ID of each point
+ * @param inliers One flag per point, or nullptr if all of them were used
+ * @param count Number of points
+ */
+template <int Dims>
+void Trilateration<Dims>::markInliers(const uint16_t *ids, const bool *inliers, int count)
+{
+    for (int i = 0; i < count; ++i)
     {
-        // Find the plane equation
-        Plane plane = findPlane(V, centroid);
-        Serial.printf("Plane equation: %.2fx + %.2fy + %.2fz + %.2f = 0\n", plane.a, plane.b, plane.c, plane.d);
+        registry.setInlier(ids[i], inliers ? inliers[i] : true);
+    }
+}
 
-        // Project the points onto the plane
-        Matrix projectedPoints = projectPointsOntoPlane(centeredCords, plane);
-        Serial.println("Projected Points:");
-        projectedPoints.print();
+/**
+ * @brief Update the Kalman filter with a new position fix.
+ *
+ * @param position Dims coordinates
+ * @param now Time of the fix in milliseconds
+ */
+template <int Dims>
+void Trilateration<Dims>::updateFilter(const float *position, unsigned long now)
+{
+    LOG_DEBUG(LOG_MODULE_TRILATERATION, "Final Point: %.3f %.3f %.3f", position[0], position[1], Dims == 3 ? position[Dims - 1] : 0.0f);
 
-        // Convert the 3D points to 2D coordinates
-        Matrix planeU = V.getColumn(0).transpose();
-        Matrix planeV = V.getColumn(1).transpose();
-        planeU *= (1.0 / planeU.norm());
-        planeV *= (1.0 / planeV.norm());
-        Serial.println("Vector U:");
-        planeU.print();
-        Serial.println("Vector V:");
-        planeV.print();
+    // The first fix, or one after the track was lost, starts the filter over
+    if (!hasFix || now - lastFixMs > registry.maxAge())
+    {
+        kf.reset();
+        historyCount = 0;
+    }
+    hasFix = true;
+    lastFixMs = now;
 
-        // Convert the 3D points to 2D coordinates
-        Matrix projected2D = convert3DTo2D(projectedPoints, planeU, planeV);
-        Serial.println("Projected 2D Points:");
-        projected2D.print();
+    HistoryEntry entry;
+    entry.timeUs = latestRangeUs;
+    entry.isRange = false;
+    std::copy(position, position + Dims, entry.values);
+    applyMeasurement(entry);
+}
 
-        // Compute the linear equations
-        equations = computeEquations(projected2D, distances);
+/**
+ * @brief Apply a measurement at its own time.
+ *
+ * A measurement newer than the filter is applied after predicting the filter
+ * to its timestamp. An older one, e.g. from a slower serial or network path,
+ * is applied by retrodiction: the filter returns to its saved state at the
+ * last measurement before it, applies it, and replays the measurements that
+ * followed. The replay is bounded by KF_HISTORY_SIZE; a measurement older
+ * than the whole history is dropped.
+ *
+ * @param entry The measurement; its filter snapshot is filled in
+ * @return TrackingStatus TRACKING_OK, TRACKING_OUTLIER if the filter rejected it, or TRACKING_STALE
+ */
+template <int Dims>
+TrackingStatus Trilateration<Dims>::applyMeasurement(HistoryEntry &entry)
+{
+    if (historyCount == 0 || (long)(entry.timeUs - filterUs) >= 0)
+    {
+        if (historyCount > 0)
+        {
+            kf.predict((entry.timeUs - filterUs) / 1e6f);
+        }
+        bool accepted = measure(entry);
+        kf.save(entry.after);
+        filterUs = entry.timeUs;
+        if (historyCount == KF_HISTORY_SIZE)
+        {
+            historyStart = (historyStart + 1) % KF_HISTORY_SIZE;
+            --historyCount;
+        }
+        historyAt(historyCount++) = entry;
+        return accepted ? TRACKING_OK : TRACKING_OUTLIER;
     }
 
-    Matrix A = equations.first;
-    Matrix b = equations.second;
+    // Out of sequence: find the last measurement before it
+    int previous = historyCount - 1;
+    while (previous >= 0 && (long)(historyAt(previous).timeUs - entry.timeUs) > 0)
+    {
+        --previous;
+    }
+    if (previous < 0)
+    {
+        ++lateMeasurements;
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Measurement %lu us older than the filter history, dropped.", (unsigned long)(filterUs - entry.timeUs));
+        return TRACKING_STALE;
+    }
+    LOG_DEBUG(LOG_MODULE_TRILATERATION, "Measurement %lu us late, replaying %d.", (unsigned long)(filterUs - entry.timeUs), historyCount - 1 - previous);
+    kf.restore(historyAt(previous).after);
+    unsigned long timeUs = historyAt(previous).timeUs;
 
-    // Solve the linear equations
-    Matrix x = solveLeastSquares(A, b);
-    Serial.println("LS Solution:");
-    x.print();
+    // Insert it after that one, dropping the oldest entry if the history is full
+    if (historyCount == KF_HISTORY_SIZE)
+    {
+        historyStart = (historyStart + 1) % KF_HISTORY_SIZE;
+        --historyCount;
+        --previous;
+    }
+    for (int i = historyCount; i > previous + 1; --i)
+    {
+        historyAt(i) = historyAt(i - 1);
+    }
+    historyAt(previous + 1) = entry;
+    ++historyCount;
 
-    // Convert the solution back to 3D coordinates, if necessary
-    if (numOfDimensions == 3 && x.cols() == 2)
+    bool accepted = true;
+    for (int i = previous + 1; i < historyCount; ++i)
     {
-        Matrix lsSolution2D = x;
-        Matrix planeU = V.getColumn(0).transpose();
-        Matrix planeV = V.getColumn(1).transpose();
-        planeU *= (1.0 / planeU.norm());
-        planeV *= (1.0 / planeV.norm());
-        x = reconstruct3D(lsSolution2D, planeU, planeV);
-        Serial.println("Reconstructed 3D Point:");
-        x.print();
+        HistoryEntry &replayed = historyAt(i);
+        kf.predict((replayed.timeUs - timeUs) / 1e6f);
+        bool applied = measure(replayed);
+        if (i == previous + 1)
+        {
+            accepted = applied;
+        }
+        kf.save(replayed.after);
+        timeUs = replayed.timeUs;
     }
-    x = x + centroid; // Add the centroid to the solution
+    return accepted ? TRACKING_OK : TRACKING_OUTLIER;
+}
 
-    Serial.println("Final Point:");
-    x.print();
+/**
+ * @brief Update the filter with a measurement; its time must already be predicted to
+ *
+ * @return true if the filter accepted it
+ */
+template <int Dims>
+bool Trilateration<Dims>::measure(const HistoryEntry &entry)
+{
+    if (entry.isRange)
+    {
+        return kf.updateRange(entry.values, entry.values[3], EKF_RANGE_VARIANCE, EKF_INNOVATION_GATE);
+    }
+    typename TrackerFilter<Dims>::MeasurementVector measurement;
+    for (int j = 0; j < Dims; ++j)
+    {
+        measurement[j][0] = entry.values[j];
+    }
+    kf.update(measurement);
+    return true;
+}
 
-    // Update the Kalman filter with the new solution
-    kf.update(x);
+/**
+ * @brief Predict the filter to the range's time and update it with the range (extended Kalman filter).
+ *
+ * Ranges far outside the predicted uncertainty are rejected; after
+ * EKF_MAX_REJECTED in a row the track is considered lost and the next range
+ * solves a fix from all anchors again.
+ *
+ * @param anchor Anchor the range was measured to
+ * @param distance Measured distance
+ * @param timestampUs micros() when the range was measured
+ * @return TrackingStatus TRACKING_OK, TRACKING_OUTLIER if the range was rejected, or TRACKING_STALE
+ */
+template <int Dims>
+TrackingStatus Trilateration<Dims>::updateFilterRange(const AnchorEntry &anchor, float distance, unsigned long timestampUs)
+{
+    lastFixMs = millis();
+
+    HistoryEntry entry;
+    entry.timeUs = timestampUs;
+    entry.isRange = true;
+    entry.values[0] = anchor.x;
+    entry.values[1] = anchor.y;
+    entry.values[2] = anchor.z;
+    entry.values[3] = distance;
+    TrackingStatus status = applyMeasurement(entry);
+    if (status == TRACKING_STALE)
+    {
+        return status;
+    }
+    if (status != TRACKING_OK)
+    {
+        registry.setInlier(anchor.id, false);
+        LOG_DEBUG(LOG_MODULE_TRILATERATION, "Range %.2f from anchor %04X rejected by the filter.", distance, anchor.id);
+        if (++rejectedRanges >= EKF_MAX_REJECTED)
+        {
+            LOG_WARN(LOG_MODULE_TRILATERATION, "Warning: %d ranges in a row rejected, reinitializing.", rejectedRanges);
+            hasFix = false;
+            rejectedRanges = 0;
+        }
+        return TRACKING_OUTLIER;
+    }
+    rejectedRanges = 0;
+    registry.setInlier(anchor.id, true);
+    return TRACKING_OK;
+}
+
+/**
+ * @brief Get the current state of the Kalman filter.
+ *
+ * @return StateVector The current state of the Kalman filter.
+ */
+template <int Dims>
+typename TrackerFilter<Dims>::StateVector Trilateration<Dims>::getState() const
+{
+    return kf.getState();
+}
+
+/**
+ * @brief Feed each range to the filter instead of solving a fix per round.
+ *
+ * Needs a filter that applies ranges; with TRACKER_FILTER_DECOUPLED the mode
+ * stays off.
+ */
+template <int Dims>
+void Trilateration<Dims>::setTightlyCoupled(bool enabled)
+{
+#if defined(TRACKER_FILTER_DECOUPLED)
+    if (enabled)
+    {
+        LOG_WARN(LOG_MODULE_TRILATERATION, "Warning: The decoupled filter cannot apply single ranges; tightly coupled mode stays off.");
+    }
+    enabled = false;
+#endif
+    tightlyCoupled = enabled;
+}
+
+/**
+ * @brief Print the anchor table with the latest ranges.
+ */
+template <int Dims>
+void Trilateration<Dims>::printBuffer() const
+{
+    registry.print(millis());
+    if (lateMeasurements > 0)
+    {
+        Serial.printf("%lu measurements arrived too late for the filter history\n", (unsigned long)lateMeasurements);
+    }
+}
+
+template class Trilateration<2>;
+template class Trilateration<3>;
+
+/**
+ * @brief Initialize the trilateration algorithm.
+ *
+ * @param numOfDimensions The number of dimensions (2D or 3D)
+ */
+trilateration::trilateration(int numOfDimensions)
+    : numOfDimensions(numOfDimensions), trilateration2D(&selector2D), trilateration3D(&selector3D),
+      selector2D(trilateration2D.anchors()), selector3D(trilateration3D.anchors())
+{
+}
+
+/**
+ * @brief Switch between the 2D and the 3D tracker.
+ *
+ * Both trackers already exist, so anchors, ranges and settings of each are
+ * kept; nothing is rebuilt.
+ *
+ * @param dimensions 2 or 3
+ */
+void trilateration::setDimensions(int dimensions)
+{
+    numOfDimensions = dimensions;
+}
+
+/**
+ * @brief Update the trilateration algorithm with a new data point.
+ *
+ * @param point The new data point (x, y, z, d)
+ * @return TrackingStatus TRACKING_OK if the filter was updated, otherwise why not
+ */
+TrackingStatus trilateration::update(const DataPoint &point)
+{
+    if (numOfDimensions == 2)
+        return trilateration2D.update(point);
+    return trilateration3D.update(point);
+}
+
+/**
+ * @brief Update the trilateration algorithm with a range to a registered anchor.
+ *
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance to the anchor
+ * @return TrackingStatus TRACKING_OK if the filter was updated, otherwise why not
+ */
+TrackingStatus trilateration::updateRange(uint16_t anchorId, float distance)
+{
+    if (numOfDimensions == 2)
+        return trilateration2D.updateRange(anchorId, distance);
+    return trilateration3D.updateRange(anchorId, distance);
+}
+
+/**
+ * @brief Update the trilateration algorithm with a timestamped range.
+ *
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance to the anchor
+ * @param timestampUs micros() when the range was measured
+ * @return TrackingStatus TRACKING_OK if the filter was updated, otherwise why not
+ */
+TrackingStatus trilateration::updateRange(uint16_t anchorId, float distance, unsigned long timestampUs)
+{
+    if (numOfDimensions == 2)
+        return trilateration2D.updateRange(anchorId, distance, timestampUs);
+    return trilateration3D.updateRange(anchorId, distance, timestampUs);
+}
+
+/**
+ * @brief Store a range to a registered anchor without solving.
+ *
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance to the anchor
+ * @return TrackingStatus TRACKING_OK, or TRACKING_UNKNOWN_ANCHOR
+ */
+TrackingStatus trilateration::recordRange(uint16_t anchorId, float distance)
+{
+    if (numOfDimensions == 2)
+        return trilateration2D.recordRange(anchorId, distance);
+    return trilateration3D.recordRange(anchorId, distance);
+}
+
+/**
+ * @brief Store a timestamped range without solving.
+ *
+ * @param anchorId Short address of the anchor
+ * @param distance Measured distance to the anchor
+ * @param timestampUs micros() when the range was measured
+ * @return TrackingStatus TRACKING_OK, or TRACKING_UNKNOWN_ANCHOR
+ */
+TrackingStatus trilateration::recordRange(uint16_t anchorId, float distance, unsigned long timestampUs)
+{
+    if (numOfDimensions == 2)
+        return trilateration2D.recordRange(anchorId, distance, timestampUs);
+    return trilateration3D.recordRange(anchorId, distance, timestampUs);
+}
+
+/**
+ * @brief Compute a fix from the recorded ranges and feed it to the Kalman filter.
+ *
+ * @return TrackingStatus TRACKING_OK if the filter was updated, otherwise why not
+ */
+TrackingStatus trilateration::solve()
+{
+    if (numOfDimensions == 2)
+        return trilateration2D.solve();
+    return trilateration3D.solve();
+}
+
+/**
+ * @brief Get the anchor registry of the active dimension.
+ *
+ * @return AnchorRegistry& Anchors and their latest ranges
+ */
+AnchorRegistry &trilateration::anchors()
+{
+    if (numOfDimensions == 2)
+        return trilateration2D.anchors();
+    return trilateration3D.anchors();
+}
+
+/**
+ * @brief Enable or disable RANSAC outlier rejection in both dimensions.
+ */
+void trilateration::setRobust(bool enabled)
+{
+    trilateration2D.setRobust(enabled);
+    trilateration3D.setRobust(enabled);
+}
+
+/**
+ * @brief Switch steady-state Kalman gains in both dimensions.
+ *
+ * @param enabled Use steady-state gains
+ * @param dt Expected time step (s) between fixes, whose gains are precomputed
+ */
+void trilateration::setSteadyState(bool enabled, float dt)
+{
+    trilateration2D.setSteadyState(enabled, dt);
+    trilateration3D.setSteadyState(enabled, dt);
+}
+
+/**
+ * @brief Switch tightly coupled (per-range EKF) updates in both dimensions.
+ */
+void trilateration::setTightlyCoupled(bool enabled)
+{
+    trilateration2D.setTightlyCoupled(enabled);
+    trilateration3D.setTightlyCoupled(enabled);
+}
+
+/**
+ * @brief Whether ranges are fed straight to the filter
+ */
+bool trilateration::isTightlyCoupled() const
+{
+    if (numOfDimensions == 2)
+        return trilateration2D.isTightlyCoupled();
+    return trilateration3D.isTightlyCoupled();
 }
 
 /**
@@ -161,17 +672,46 @@ void trilateration::update(const DataPoint &point)
  */
 Matrix trilateration::getState() const
 {
-    return kf.getState();
+    if (numOfDimensions == 2)
+        return Matrix(trilateration2D.getState().view());
+    return Matrix(trilateration3D.getState().view());
 }
 
 /**
- * @brief Print the contents of the buffer.
+ * @brief Get the filtered position and velocity without allocating a Matrix.
+ *
+ * @param position Output, x, y, z (z = 0 in 2D)
+ * @param velocity Output, vx, vy, vz (vz = 0 in 2D)
  */
-void trilateration::printBuffer() const
+void trilateration::getPosition(float *position, float *velocity) const
 {
-    Serial.println("Buffer contents:");
-    for (int i = 0; i < count; ++i)
+    position[2] = 0;
+    velocity[2] = 0;
+    if (numOfDimensions == 2)
+    {
+        TrackerFilter<2>::StateVector state = trilateration2D.getState();
+        for (int j = 0; j < 2; ++j)
+        {
+            position[j] = state(j, 0);
+            velocity[j] = state(j + 2, 0);
+        }
+        return;
+    }
+    TrackerFilter<3>::StateVector state = trilateration3D.getState();
+    for (int j = 0; j < 3; ++j)
     {
-        Serial.printf("Point %d: x=%.2f, y=%.2f, z=%.2f, d=%.2f\n", i, buffer[i].x, buffer[i].y, buffer[i].z, buffer[i].d);
+        position[j] = state(j, 0);
+        velocity[j] = state(j + 3, 0);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Print the anchor table with the latest ranges.
+ */
+void trilateration::printBuffer() const
+{
+    if (numOfDimensions == 2)
+        trilateration2D.printBuffer();
+    else
+        trilateration3D.printBuffer();
+}
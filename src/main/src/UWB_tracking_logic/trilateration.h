@@ -5,32 +5,147 @@
 #include "matrix.h"
 #include "leastSquare.h"
 #include "KalmanFilter.h"
+#include "anchorRegistry.h"
+#include "incrementalLeastSquares.h"
+#include "anchorGeometry.h"
+#include "rangeRefinement.h"
+#include "closedFormSolver.h"
+#include "robustSolver.h"
+#include "anchorSelector.h"
 
-#define BUFFER_SIZE 10 // Number of stored data points
+#ifndef EKF_RANGE_VARIANCE
+#define EKF_RANGE_VARIANCE 0.01f // Variance of a single UWB range (m^2) in tightly coupled mode
+#endif
 
-struct DataPoint
+#ifndef EKF_INNOVATION_GATE
+#define EKF_INNOVATION_GATE 16.0f // Squared normalized residual above which a range is rejected (4 sigma)
+#endif
+
+#ifndef EKF_MAX_REJECTED
+#define EKF_MAX_REJECTED 8 // Consecutive rejected ranges after which the filter is reinitialized
+#endif
+
+#ifndef KF_HISTORY_SIZE
+#define KF_HISTORY_SIZE 6 // Past measurements kept to apply late ones; bounds memory and replay cost
+#endif
+
+/*
+ * Filter of every tracker, selected at compile time:
+ *  - DecoupledKalmanFilter when TRACKER_FILTER_DECOUPLED is defined; tightly coupled mode stays off
+ *  - UDKalmanFilter when TRACKER_FILTER_UD is defined, for long runs without covariance drift
+ *  - KalmanFilter otherwise
+ */
+#if defined(TRACKER_FILTER_DECOUPLED)
+template <int Dims>
+using TrackerFilter = DecoupledKalmanFilter<Dims>;
+#elif defined(TRACKER_FILTER_UD)
+template <int Dims>
+using TrackerFilter = UDKalmanFilter<Dims>;
+#else
+template <int Dims>
+using TrackerFilter = KalmanFilter<Dims>;
+#endif
+
+/**
+ * @brief Trilateration pipeline for a fixed number of dimensions.
+ *
+ * The anchor selector is shared with the other trackers of the same site and
+ * owned by whoever owns them; without one, every fresh anchor is used.
+ *
+ * @tparam Dims Number of dimensions (2 for 2D, 3 for 3D)
+ */
+template <int Dims>
+class Trilateration
 {
-    float x, y, z;  // Coordinates of the anchor point
-    float d;        // Distance to the target
+public:
+    explicit Trilateration(AnchorSelector<Dims> *selector = nullptr);
+    TrackingStatus update(const DataPoint &point);
+    TrackingStatus updateRange(uint16_t anchorId, float distance);
+    TrackingStatus updateRange(uint16_t anchorId, float distance, unsigned long timestampUs);
+    TrackingStatus recordRange(uint16_t anchorId, float distance);
+    TrackingStatus recordRange(uint16_t anchorId, float distance, unsigned long timestampUs);
+    TrackingStatus solve();
+    typename TrackerFilter<Dims>::StateVector getState() const;
+    AnchorRegistry &anchors() { return registry; }
+    void setRobust(bool enabled) { robust = enabled; }
+    bool isRobust() const { return robust; }
+    void setTightlyCoupled(bool enabled);
+    bool isTightlyCoupled() const { return tightlyCoupled; }
+    void setSteadyState(bool enabled, float dt = KF_STEADY_STATE_DT) { kf.setSteadyState(enabled, dt); }
+    void printBuffer() const;
+
+private:
+    /**
+     * @brief A measurement applied to the filter, kept to replay after a late one
+     */
+    struct HistoryEntry
+    {
+        unsigned long timeUs;                        // When the measurement was taken
+        bool isRange;                                // Range to an anchor, otherwise a position fix
+        float values[4];                             // Fix coordinates, or anchor x, y, z and the range
+        typename TrackerFilter<Dims>::Snapshot after; // Filter right after the measurement
+    };
+
+    TrackingStatus updateFilterRange(const AnchorEntry &anchor, float distance, unsigned long timestampUs);
+    TrackingStatus solveLinear(const DataPoint *points, int count, unsigned long now, float *position);
+    void predictPosition(unsigned long timeUs, float *position) const;
+    void markInliers(const uint16_t *ids, const bool *inliers, int count);
+    void updateFilter(const float *position, unsigned long now);
+    TrackingStatus applyMeasurement(HistoryEntry &entry);
+    bool measure(const HistoryEntry &entry);
+    HistoryEntry &historyAt(int index) { return history[(historyStart + index) % KF_HISTORY_SIZE]; }
+
+    TrackerFilter<Dims> kf;                    // Kalman filter object
+    AnchorTable<> registry;                    // Anchors and their latest ranges
+    IncrementalLeastSquares<Dims> incremental; // Normal equations of the fresh ranges
+    AnchorGeometry<Dims> geometry;             // Cached geometry of the full solve
+    AnchorSelector<Dims> *selector;            // Best-GDOP subset on large sites, shared per site
+    bool robust;                               // Vote out inconsistent ranges with RANSAC
+    bool tightlyCoupled;                       // Feed each range to the filter instead of solving a fix
+    int rejectedRanges;                        // Consecutive ranges rejected by the filter
+    bool hasFix;                               // A fix has been fed to the filter
+    unsigned long lastFixMs;                   // millis() of the latest fix
+    unsigned long latestRangeUs;               // Timestamp of the newest recorded range
+    unsigned long filterUs;                    // Time the filter state refers to
+    HistoryEntry history[KF_HISTORY_SIZE];     // Latest measurements, oldest first from historyStart
+    int historyStart, historyCount;
+    uint32_t lateMeasurements;                 // Measurements older than the whole history, dropped
 };
 
 /**
- * @brief Trilateration class.
+ * @brief Trilateration class with the number of dimensions chosen at runtime.
+ *
+ * Forwards to the Trilateration<2> or Trilateration<3> instance.
  */
 class trilateration
 {
 public:
     trilateration(int numOfDimensions = 3);
-    void update(const DataPoint &point);
+    void setDimensions(int dimensions);
+    TrackingStatus update(const DataPoint &point);
+    TrackingStatus updateRange(uint16_t anchorId, float distance);
+    TrackingStatus updateRange(uint16_t anchorId, float distance, unsigned long timestampUs);
+    TrackingStatus recordRange(uint16_t anchorId, float distance);
+    TrackingStatus recordRange(uint16_t anchorId, float distance, unsigned long timestampUs);
+    TrackingStatus solve();
     Matrix getState() const;
+    void getPosition(float *position, float *velocity) const;
+    AnchorRegistry &anchors();
+    void setRobust(bool enabled);
+    void setTightlyCoupled(bool enabled);
+    bool isTightlyCoupled() const;
+    void setSteadyState(bool enabled, float dt = KF_STEADY_STATE_DT);
     void printBuffer() const;
 
 private:
+    trilateration(const trilateration &) = delete; // The trackers point at the selectors below
+    trilateration &operator=(const trilateration &) = delete;
+
     int numOfDimensions; // Number of dimensions (2D or 3D)
-    int bufferIndex = 0; // Points to the next insertion position
-    int count = 0;       // Number of data points in the buffer
-    KalmanFilter kf;     // Kalman filter object
-    DataPoint buffer[BUFFER_SIZE]; // Circular buffer for storing data points
+    Trilateration<2> trilateration2D;
+    Trilateration<3> trilateration3D;
+    AnchorSelector<2> selector2D; // Over the anchors of trilateration2D
+    AnchorSelector<3> selector3D; // Over the anchors of trilateration3D
 };
 
-#endif // TRILATERATION_H
\ No newline at end of file
+#endif // TRILATERATION_H
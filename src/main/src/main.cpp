@@ -87,4 +87,5 @@ void loop()
 
     server.handleClient();
     UWB_loop();
+    serviceFilterSoak();
 }
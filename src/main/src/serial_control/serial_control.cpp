@@ -35,7 +35,7 @@ void handleSerialInput()
                 is2D = false;
                 modeSet = true;
                 Serial.println("3D mode set.");
-                trilat = trilateration(3); // Initialize 3D trilateration
+                trilat.setDimensions(3); // Switch to 3D trilateration
             }
             else if (!modeSet && sscanf(input.c_str(), "cords[%f,%f],%f", &x, &y, &d) == 3 ||
                      sscanf(input.c_str(), "cords[%f,%f]", &x, &y) == 2)
@@ -43,7 +43,7 @@ void handleSerialInput()
                 is2D = true;
                 modeSet = true;
                 Serial.println("2D mode set.");
-                trilat = trilateration(2); // Initialize 2D trilateration
+                trilat.setDimensions(2); // Switch to 2D trilateration
             }
 
             // After mode is determined, parse using the right pattern
@@ -56,7 +56,7 @@ void handleSerialInput()
                 if (is2D)
                 {
                     Serial.println("Warning: Input is 3D but mode is set to 2D. Ignoring z-coordinate.");
-                    trilat.update({x, y, d});
+                    trilat.update({x, y, 0, d});
                 }
                 else
                 {
@@ -77,7 +77,7 @@ void handleSerialInput()
                 }
                 else
                 {
-                    trilat.update({x, y, d});
+                    trilat.update({x, y, 0, d});
                 }
             }
             else
@@ -85,6 +85,110 @@ void handleSerialInput()
                 Serial.println("Invalid input format. Expected format: cords[x,y,z],d or cords[x,y],d or cords[x,y,z] or cords[x,y]");
             }
         }
+        // Anchor registry: "anchor ID x y z" registers an anchor (ID in hex),
+        // "range ID d [AGE_MS]" feeds a range to it, "anchor age MS" sets the expiry
+        else if (input.startsWith("anchor age "))
+        {
+            unsigned long age;
+            if (sscanf(input.c_str(), "anchor age %lu", &age) == 1)
+            {
+                trilat.anchors().setMaxAge(age);
+                Serial.printf("Ranges expire after %lu ms\n", age);
+            }
+            else
+            {
+                Serial.println("Invalid input format. Expected format: anchor age MS");
+            }
+        }
+        else if (input.startsWith("anchor "))
+        {
+            unsigned int id;
+            float x, y, z = 0;
+            int fields = sscanf(input.c_str(), "anchor %x %f %f %f", &id, &x, &y, &z);
+            if (fields == 4 || fields == 3)
+            {
+                trilat.anchors().setAnchor(id, x, y, z);
+                tagPool.setAnchor(id, x, y, z);
+                Serial.printf("Anchor %04X at %.2f, %.2f, %.2f\n", id, x, y, z);
+            }
+            else
+            {
+                Serial.println("Invalid input format. Expected format: anchor ID x y z or anchor ID x y");
+            }
+        }
+        // "robust on|off" toggles RANSAC rejection of NLOS ranges
+        else if (input == "robust on" || input == "robust off")
+        {
+            trilat.setRobust(input == "robust on");
+            Serial.printf("Robust solving %s\n", input == "robust on" ? "enabled" : "disabled");
+        }
+        // "ekf on|off" feeds each range straight to the filter instead of solving a fix per round
+        else if (input == "ekf on" || input == "ekf off")
+        {
+            trilat.setTightlyCoupled(input == "ekf on");
+            bool enabled = trilat.isTightlyCoupled();
+            pipeline.setPolicy(enabled ? BATCH_PER_RANGE : BATCH_PER_ROUND);
+            Serial.printf("Tightly coupled EKF %s\n", enabled ? "enabled" : "disabled");
+        }
+        // "steady on [MS]|off" replaces covariance propagation with gains precomputed for fixes every MS
+        else if (input.startsWith("steady on"))
+        {
+            unsigned long interval = (unsigned long)(KF_STEADY_STATE_DT * 1000);
+            sscanf(input.c_str(), "steady on %lu", &interval);
+            trilat.setSteadyState(true, interval / 1000.0f);
+            Serial.printf("Steady-state gains enabled for fixes every %lu ms\n", interval);
+        }
+        else if (input == "steady off")
+        {
+            trilat.setSteadyState(false);
+            Serial.println("Steady-state gains disabled");
+        }
+        else if (input.startsWith("range "))
+        {
+            unsigned int id;
+            float d;
+            unsigned long age = 0;
+            if (sscanf(input.c_str(), "range %x %f %lu", &id, &d, &age) >= 2)
+            {
+                // An age in milliseconds marks a range measured earlier than it is entered
+                TrackingStatus status = trilat.updateRange(id, d, micros() - age * 1000);
+                if (status == TRACKING_UNKNOWN_ANCHOR)
+                {
+                    Serial.printf("Unknown anchor %04X\n", id);
+                }
+                else if (status == TRACKING_STALE)
+                {
+                    Serial.println("Range older than the filter history, dropped");
+                }
+            }
+            else
+            {
+                Serial.println("Invalid input format. Expected format: range ID d [AGE_MS]");
+            }
+        }
+        // Multi-tag tracking: "tags" lists the tracked tags, "tagrange TAG ANCHOR d"
+        // feeds a range between a tag and an anchor (IDs in hex)
+        else if (input == "tags")
+        {
+            tagPool.print();
+        }
+        else if (input.startsWith("tagrange "))
+        {
+            unsigned int tag, anchor;
+            float d;
+            if (sscanf(input.c_str(), "tagrange %x %x %f", &tag, &anchor, &d) == 3)
+            {
+                TrackingStatus status = tagPool.updateRange(tag, anchor, d);
+                if (status == TRACKING_UNKNOWN_ANCHOR)
+                {
+                    Serial.printf("Unknown anchor %04X\n", anchor);
+                }
+            }
+            else
+            {
+                Serial.println("Invalid input format. Expected format: tagrange TAG ANCHOR d");
+            }
+        }
         else if (input == "getState")
         {
             Matrix state = trilat.getState();
@@ -103,6 +207,53 @@ void handleSerialInput()
         {
             trilat.printBuffer();
         }
+        else if (input == "pipeline")
+        {
+            pipeline.printStats();
+        }
+        else if (input == "pipeline reset")
+        {
+            pipeline.resetStats();
+        }
+        // "pipeline range|round|rate [MS]" sets when the pipeline solves
+        else if (input == "pipeline range")
+        {
+            pipeline.setPolicy(BATCH_PER_RANGE);
+        }
+        else if (input == "pipeline round")
+        {
+            pipeline.setPolicy(BATCH_PER_ROUND);
+        }
+        else if (input.startsWith("pipeline rate"))
+        {
+            unsigned long interval = BATCH_INTERVAL_MS;
+            sscanf(input.c_str(), "pipeline rate %lu", &interval);
+            pipeline.setPolicy(BATCH_FIXED_RATE, interval);
+            Serial.printf("Solving every %lu ms\n", interval);
+        }
+        else if (input == "arena")
+        {
+            trackingArena.printStats();
+        }
+        else if (input == "kernels")
+        {
+            kernelSelfTest();
+        }
+        else if (input == "benchmark")
+        {
+            runTrackingBenchmark();
+        }
+        else if (input == "scalars")
+        {
+            runScalarComparison();
+        }
+        // "soak [STEPS]" runs the float filters against a double reference for a long time, from the main loop
+        else if (input.startsWith("soak"))
+        {
+            long steps = 100000;
+            sscanf(input.c_str(), "soak %ld", &steps);
+            startFilterSoak(steps);
+        }
 
         // WiFi control
         else if (input == "WiFi auto")
@@ -204,6 +355,21 @@ void handleSerialInput()
             Serial.println("cords[x,y,z],d or cords[x,y],d or cords[x,y,z] or cords[x,y]");
             Serial.println("getState");
             Serial.println("printBuffer");
+            Serial.println("anchor ID x y z or anchor ID x y");
+            Serial.println("anchor age MS");
+            Serial.println("range ID d [AGE_MS]");
+            Serial.println("robust on|off");
+            Serial.println("ekf on|off");
+            Serial.println("steady on [MS]|off");
+            Serial.println("tags");
+            Serial.println("tagrange TAG ANCHOR d");
+            Serial.println("pipeline, pipeline reset");
+            Serial.println("pipeline range|round|rate [MS]");
+            Serial.println("arena");
+            Serial.println("benchmark");
+            Serial.println("scalars");
+            Serial.println("soak [STEPS]");
+            Serial.println("kernels");
             Serial.println("WiFi auto");
             Serial.println("WiFi AP");
             Serial.println("WiFi connect to SSID PASSWORD");
@@ -3,9 +3,12 @@
 #include <Arduino.h>
 #include "config.h"
 #include "UWB_tracking_logic/trilateration.h"
+#include "UWB_tracking_logic/benchmark.h"
 #include "wifi_connection/wifi_connection.h"
 #include "wifi_location/wifi_location.h"
 #include "UWB/UWB.h"
 
+extern trilateration trilat; // Tracker shared by the serial commands and the UWB pipeline
+
 void handleSerialInput();
 #endif
\ No newline at end of file
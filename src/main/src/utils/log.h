@@ -0,0 +1,70 @@
+#ifndef UTIL_LOG_H
+#define UTIL_LOG_H
+
+#include <Arduino.h>
+
+/*
+ * Compile-time logging.
+ *
+ * A statement is emitted only if its level is at or below LOG_LEVEL and its
+ * module bit is set in LOG_MODULES. Both are constants, so a disabled
+ * statement folds to `if (0)` and compiles to nothing, arguments included.
+ * Override them with build flags, e.g.
+ *
+ *   build_flags = -D LOG_LEVEL=LOG_LEVEL_DEBUG -D LOG_MODULES=LOG_MODULE_UWB
+ *
+ * Per-step dumps (matrices, every range, every BSSID comparison) are DEBUG or
+ * TRACE: at 115200 baud they would otherwise cap the update rate.
+ */
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_TRACE 5
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_MODULE_MATH (1u << 0)          // Matrix and solver internals
+#define LOG_MODULE_TRILATERATION (1u << 1) // Trilateration pipeline and Kalman filter
+#define LOG_MODULE_UWB (1u << 2)           // DW1000 ranging callbacks and calibration
+#define LOG_MODULE_WIFI_LOCATION (1u << 3) // Wi-Fi fingerprint matching
+#define LOG_MODULE_ALL 0xFFFFFFFFu
+
+#ifndef LOG_MODULES
+#define LOG_MODULES LOG_MODULE_ALL
+#endif
+
+#define LOG_ENABLED(module, level) ((((LOG_MODULES) & (module)) != 0) && (LOG_LEVEL) >= (level))
+
+// printf-style; the format must be a string literal, a newline is appended
+#define LOG_AT(module, level, fmt, ...)                 \
+    do                                                  \
+    {                                                   \
+        if (LOG_ENABLED(module, level))                 \
+        {                                               \
+            Serial.printf(fmt "\n", ##__VA_ARGS__);     \
+        }                                               \
+    } while (0)
+
+#define LOG_ERROR(module, fmt, ...) LOG_AT(module, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_WARN(module, fmt, ...) LOG_AT(module, LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_INFO(module, fmt, ...) LOG_AT(module, LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(module, fmt, ...) LOG_AT(module, LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_TRACE(module, fmt, ...) LOG_AT(module, LOG_LEVEL_TRACE, fmt, ##__VA_ARGS__)
+
+// Label followed by anything with a print() method (Matrix)
+#define LOG_MATRIX(module, level, label, matrix) \
+    do                                           \
+    {                                            \
+        if (LOG_ENABLED(module, level))          \
+        {                                        \
+            Serial.println(label);               \
+            (matrix).print();                    \
+        }                                        \
+    } while (0)
+
+#endif // UTIL_LOG_H
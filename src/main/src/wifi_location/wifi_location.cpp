@@ -23,48 +23,35 @@ float calculate_similarity(const JsonObject &networks)
         const char *c_BSSID = WiFi.BSSIDstr(scan_index).c_str();
         int c_RSSI = WiFi.RSSI(scan_index);
 
-        Serial.print("\nComparing: ");
-        Serial.print(c_SSID);
-        Serial.print(" ");
-        Serial.print(c_BSSID);
-        Serial.print(" ");
-        Serial.println(c_RSSI);
+        LOG_TRACE(LOG_MODULE_WIFI_LOCATION, "\nComparing: %s %s %d", c_SSID, c_BSSID, c_RSSI);
 
         for (JsonPair kv : networks)
         {
             const char *t_BSSID = kv.key().c_str();
             int t_RSSI = kv.value().as<int>();
 
-            Serial.print("With: ");
-            Serial.print(t_BSSID);
-            Serial.print(" ");
-            Serial.println(t_RSSI);
+            LOG_TRACE(LOG_MODULE_WIFI_LOCATION, "With: %s %d", t_BSSID, t_RSSI);
 
             float weight = exp((c_RSSI + t_RSSI) / (2 * 50));
 
             if (strcmp(c_BSSID, t_BSSID) == 0)
             {
-                Serial.println("Common network found");
-                Serial.print("Weight: ");
-                Serial.println(weight);
+                LOG_TRACE(LOG_MODULE_WIFI_LOCATION, "Common network found");
+                LOG_TRACE(LOG_MODULE_WIFI_LOCATION, "Weight: %.2f", weight);
 
                 int diff = abs(c_RSSI - t_RSSI);
-                Serial.print("RSSI difference: ");
-                Serial.println(diff);
+                LOG_TRACE(LOG_MODULE_WIFI_LOCATION, "RSSI difference: %d", diff);
 
                 float similarity = 1 - (diff / 100.0);
-                Serial.print("Similarity: ");
-                Serial.println(similarity);
+                LOG_TRACE(LOG_MODULE_WIFI_LOCATION, "Similarity: %.2f", similarity);
 
                 common += weight * similarity;
                 break;
             }
         }
     }
-    Serial.print("Common networks: ");
-    Serial.println(common);
-    Serial.print("Total networks: ");
-    Serial.println(total);
+    LOG_DEBUG(LOG_MODULE_WIFI_LOCATION, "Common networks: %.2f", common);
+    LOG_DEBUG(LOG_MODULE_WIFI_LOCATION, "Total networks: %d", total);
     return common / total;
 }
 
@@ -86,15 +73,18 @@ void findMatchingLocation(const JsonObject &stored)
     float bestSimilarity = 0;
     float similaritySum = 0;
 
-    Serial.println("Finding matching location");
+    LOG_DEBUG(LOG_MODULE_WIFI_LOCATION, "Finding matching location");
     for (JsonPair kv : stored)
     {
         const char *locationName = kv.key().c_str();
         JsonObject locationData = kv.value().as<JsonObject>();
 
-        Serial.println("\nProcessing stored object:");
-        serializeJson(locationData, Serial);
-        Serial.println();
+        if (LOG_ENABLED(LOG_MODULE_WIFI_LOCATION, LOG_LEVEL_TRACE))
+        {
+            Serial.println("\nProcessing stored object:");
+            serializeJson(locationData, Serial);
+            Serial.println();
+        }
 
         float similarity = calculate_similarity(locationData["networks"].as<JsonObject>());
         similaritySum += similarity;
@@ -103,8 +93,7 @@ void findMatchingLocation(const JsonObject &stored)
         bestMatch.location[1] += locationData["location"][1].as<float>() * similarity;
         bestMatch.location[2] += locationData["location"][2].as<float>() * similarity;
 
-        Serial.print("Similarity: ");
-        Serial.println(similarity);
+        LOG_DEBUG(LOG_MODULE_WIFI_LOCATION, "Similarity: %.2f", similarity);
 
         if (similarity > bestSimilarity)
         {
@@ -121,7 +110,7 @@ void findMatchingLocation(const JsonObject &stored)
     }
     else
     {
-        Serial.println("No matching location found.");
+        LOG_INFO(LOG_MODULE_WIFI_LOCATION, "No matching location found.");
     }
 }
 
@@ -159,7 +148,7 @@ void handleLocation()
     File file = SPIFFS.open("/networks.json", "r");
     if (!file)
     {
-        Serial.println("Failed to open file for reading");
+        LOG_ERROR(LOG_MODULE_WIFI_LOCATION, "Failed to open file for reading");
         server.send(500, "text/plain", "Failed to open file");
         return;
     }
@@ -173,8 +162,7 @@ void handleLocation()
     DeserializationError error = deserializeJson(doc, content);
     if (error)
     {
-        Serial.print("Failed to parse JSON: ");
-        Serial.println(error.c_str());
+        LOG_ERROR(LOG_MODULE_WIFI_LOCATION, "Failed to parse JSON: %s", error.c_str());
         server.send(500, "text/plain", "Failed to parse JSON");
         return;
     }
@@ -184,8 +172,8 @@ void handleLocation()
 
     // Find the matching location
     findMatchingLocation(root);
-    Serial.println(bestMatch.name);
-    Serial.printf("Location: %f, %f, %f\n", bestMatch.location[0], bestMatch.location[1], bestMatch.location[2]);
+    LOG_INFO(LOG_MODULE_WIFI_LOCATION, "%s", bestMatch.name);
+    LOG_INFO(LOG_MODULE_WIFI_LOCATION, "Location: %f, %f, %f", bestMatch.location[0], bestMatch.location[1], bestMatch.location[2]);
 
     // Create a JSON object for the response
     JsonDocument response;
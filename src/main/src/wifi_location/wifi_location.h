@@ -7,6 +7,7 @@
 #include <SPIFFS.h>
 #include <WebServer.h>
 #include "utils/wifi.h"
+#include "utils/log.h"
 
 class WiFiLocation
 {